@@ -0,0 +1,60 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+// Heap float storage aligned for SIMD loads/stores.
+// Allocate on the message thread (prepare), never on the audio thread.
+class AlignedFloatBuffer
+{
+public:
+    static constexpr size_t alignment = 32;
+
+    AlignedFloatBuffer() = default;
+    explicit AlignedFloatBuffer (size_t numFloats) { allocate (numFloats); }
+
+    // Moves hand the storage over; the aligned pointer stays valid
+    AlignedFloatBuffer (AlignedFloatBuffer&& other) noexcept
+        : storage (std::move (other.storage)),
+          aligned (std::exchange (other.aligned, nullptr)),
+          numElements (std::exchange (other.numElements, 0))
+    {
+    }
+
+    AlignedFloatBuffer& operator= (AlignedFloatBuffer&& other) noexcept
+    {
+        storage     = std::move (other.storage);
+        aligned     = std::exchange (other.aligned, nullptr);
+        numElements = std::exchange (other.numElements, 0);
+        return *this;
+    }
+
+    void allocate (size_t numFloats)
+    {
+        storage.calloc (numFloats * sizeof (float) + alignment);
+        const auto base = reinterpret_cast<std::uintptr_t> (storage.getData());
+        aligned = reinterpret_cast<float*> ((base + alignment - 1) & ~(std::uintptr_t) (alignment - 1));
+        numElements = numFloats;
+    }
+
+    void clear() noexcept
+    {
+        if (aligned != nullptr)
+            std::memset (aligned, 0, numElements * sizeof (float));
+    }
+
+    float*       data()       noexcept { return aligned; }
+    const float* data() const noexcept { return aligned; }
+    size_t       size() const noexcept { return numElements; }
+
+    float&       operator[] (size_t i)       noexcept { return aligned[i]; }
+    const float& operator[] (size_t i) const noexcept { return aligned[i]; }
+
+private:
+    juce::HeapBlock<char> storage;
+    float* aligned     = nullptr;
+    size_t numElements = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (AlignedFloatBuffer)
+};
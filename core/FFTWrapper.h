@@ -1,32 +1,65 @@
 #pragma once
 #include <juce_dsp/juce_dsp.h>
+#include "WindowCache.h"
+#include <complex>
+#include <memory>
 #include <vector>
 
-// Simple real->complex and complex->real FFT wrapper around juce::dsp::FFT
+// View over the packed half-spectrum produced by FFTWrapper::forwardInPlace.
+// Layout: [re0, im0, re1, im1, ..., reN/2, imN/2] -> fftSize/2 + 1 complex bins.
+struct PackedSpectrum
+{
+    float* data    = nullptr;
+    int    numBins = 0;
+
+    float& re (int bin) const noexcept { return data[2 * bin]; }
+    float& im (int bin) const noexcept { return data[2 * bin + 1]; }
+
+    std::complex<float>* bins() const noexcept { return reinterpret_cast<std::complex<float>*> (data); }
+};
+
+// Simple real->complex and complex->real FFT wrapper around juce::dsp::FFT.
+// Each wrapper owns its transform, so wrappers on different threads never contend;
+// the Hann window comes from WindowCache and is shared by wrappers of the same
+// size. Construct and setOrder() off the audio thread.
 class FFTWrapper
 {
 public:
     // 'order' is log2(fftSize). e.g. order=10 => fftSize=1024
     explicit FFTWrapper (int order);
-    
+
     void setOrder (int order);                // reinitialise with new size
     int  getOrder () const { return order_; }
     int  getSize  () const { return fftSize_; }
+    int  getNumBins () const { return fftSize_ / 2 + 1; }
+
+    // Floats a caller-owned frame must hold for the in-place transforms
+    // (juce::dsp::FFT uses the upper half as scratch).
+    int  getFrameBufferSize () const { return 2 * fftSize_; }
+
+    // Zero-copy path: operates directly on a caller-owned (ideally aligned) frame.
+    // forwardInPlace: frame[0..fftSize) time samples -> packed spectrum in the same memory.
+    // inverseInPlace: packed spectrum -> frame[0..fftSize) time samples, already scaled by 1/fftSize.
+    PackedSpectrum forwardInPlace (float* frame) const noexcept;
+    void           inverseInPlace (float* frame) const noexcept;
 
     // Real input -> complex output (interleaved or separate)
-    // outReal/outImag must be size >= fftSize_/2 + 1
+    // outReal/outImag must be size >= fftSize_/2 + 1. The first call allocates.
     void forward (const float* in, float* outReal, float* outImag);
     void inverse (const float* inReal, const float* inImag, float* out);
 
     // Utility: apply a window to input before forward
     void applyWindow (float* data, int numSamples);
 
+    // Fused copy + window, e.g. input history -> FFT frame in a single pass
+    void applyWindow (const float* source, float* dest, int numSamples) const noexcept;
+
+    const float* getWindow () const noexcept { return window_->data(); }
+
 private:
     int order_    = 0;
     int fftSize_  = 0;
-    juce::dsp::FFT fft_;
-    juce::HeapBlock<float> buffer_;  // temp buffer (size 2*fftSize for juce FFT)
-    juce::HeapBlock<float> window_;  // hann window precomputed
-
-    void computeWindow();
-};
\ No newline at end of file
+    std::unique_ptr<juce::dsp::FFT> fft_;               // owned: not shared across threads
+    std::shared_ptr<const std::vector<float>> window_;  // shared hann window
+    juce::HeapBlock<float> buffer_;  // temp buffer for forward/inverse (2*fftSize), allocated on first use
+};
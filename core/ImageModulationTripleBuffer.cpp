@@ -1,8 +1,11 @@
 #include "ImageModulationTripleBuffer.h"
-#include <GL/gl.h>
+#if IMAGE_MOD_USE_GL
+    #include <GL/gl.h>
+#endif
 #include <cstdlib>
 
-ImageModulationTripleBuffer::ImageModulationTripleBuffer(size_t bufferSize)
+ImageModulationTripleBuffer::ImageModulationTripleBuffer(size_t bufferSize, Completion completionMode)
+    : completion(IMAGE_MOD_USE_GL ? completionMode : Completion::immediate)
 {
     allocateBuffers(bufferSize);
 }
@@ -28,7 +31,9 @@ void ImageModulationTripleBuffer::freeBuffers()
     for (auto& buf : buffers)
     {
         if (buf.data) std::free(buf.data);
-        if (buf.sync) glDeleteSync(buf.sync);
+#if IMAGE_MOD_USE_GL
+        if (buf.sync) glDeleteSync(static_cast<GLsync>(buf.sync));
+#endif
 
         buf.data = nullptr;
         buf.sync = nullptr;
@@ -37,36 +42,51 @@ void ImageModulationTripleBuffer::freeBuffers()
 
 void ImageModulationTripleBuffer::beginWrite(int bufferIndex)
 {
+#if IMAGE_MOD_USE_GL
     if (buffers[bufferIndex].sync)
     {
-        glDeleteSync(buffers[bufferIndex].sync);
+        glDeleteSync(static_cast<GLsync>(buffers[bufferIndex].sync));
         buffers[bufferIndex].sync = nullptr;
     }
+#endif
     buffers[bufferIndex].ready.store(false, std::memory_order_release);
 }
 
 void ImageModulationTripleBuffer::endWrite(int bufferIndex)
 {
-    buffers[bufferIndex].sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#if IMAGE_MOD_USE_GL
+    if (completion == Completion::gpuFence)
+    {
+        buffers[bufferIndex].sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return;
+    }
+#endif
+
+    // The writer's stores are complete: publish straight away
+    buffers[bufferIndex].ready.store(true, std::memory_order_release);
+    latestReadyBuffer.store(bufferIndex, std::memory_order_release);
 }
 
 void ImageModulationTripleBuffer::pollAndMarkComplete()
 {
+    // Immediate buffers were published by endWrite; only fences need polling
+#if IMAGE_MOD_USE_GL
     for (int i = 0; i < NumBuffers; ++i)
     {
         auto& buf = buffers[i];
         if (!buf.ready.load(std::memory_order_acquire) && buf.sync)
         {
-            GLenum status = glClientWaitSync(buf.sync, 0, 0);
+            GLenum status = glClientWaitSync(static_cast<GLsync>(buf.sync), 0, 0);
             if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
             {
                 buf.ready.store(true, std::memory_order_release);
                 latestReadyBuffer.store(i, std::memory_order_release);
-                glDeleteSync(buf.sync);
+                glDeleteSync(static_cast<GLsync>(buf.sync));
                 buf.sync = nullptr;
             }
         }
     }
+#endif
 }
 
 int ImageModulationTripleBuffer::getNextWriteBufferIndex()
@@ -4,21 +4,30 @@
 #include <atomic>
 #include <cstddef>
 
-struct GLsync;
+// Builds without OpenGL (headless render nodes) define IMAGE_MOD_USE_GL=0,
+// e.g. by configuring with -DIMAGE_MOD_USE_GL=OFF
+#ifndef IMAGE_MOD_USE_GL
+    #define IMAGE_MOD_USE_GL 1
+#endif
 
 class ImageModulationTripleBuffer
 {
 public:
     static constexpr int NumBuffers = 3;
 
+    // How a written buffer becomes readable: after a GL fence signals (GPU
+    // readback), or as soon as endWrite returns (CPU writers)
+    enum class Completion { gpuFence, immediate };
+
     struct Buffer {
         float* data = nullptr;
         size_t size = 0;
         std::atomic<bool> ready { false };
-        GLsync* sync = nullptr;
+        void* sync = nullptr;   // GLsync while a fence is pending
     };
 
-    ImageModulationTripleBuffer(size_t bufferSize);
+    // Without GL every buffer completes immediately, whatever is requested
+    ImageModulationTripleBuffer(size_t bufferSize, Completion completionMode = Completion::gpuFence);
     ~ImageModulationTripleBuffer();
 
     void beginWrite(int bufferIndex);
@@ -39,4 +48,5 @@ private:
     std::array<Buffer, NumBuffers> buffers;
     std::atomic<int> latestReadyBuffer { -1 };
     int writeBufferIndex = 0;
+    Completion completion;
 };
@@ -0,0 +1,69 @@
+// source/core/RealtimeHandoff.h
+#pragma once
+#include "LockFreeFIFO.h"
+#include <juce_core/juce_core.h>
+#include <memory>
+
+// Passes heap objects built on a non-realtime thread to the audio thread.
+// The audio thread never allocates or frees: objects it is done with go back
+// through the retired queue and are deleted by the producer on its next call.
+template <typename T, size_t QUEUE_SIZE = 8>
+class RealtimeHandoff
+{
+public:
+    RealtimeHandoff() = default;
+
+    ~RealtimeHandoff()
+    {
+        collectGarbage();
+        T* object = nullptr;
+        while (pending.pop(object))
+            delete object;
+    }
+
+    // Producer (message/background thread)
+    bool publish(std::unique_ptr<T> object)
+    {
+        collectGarbage();
+        if (!pending.push(object.get()))
+            return false; // Consumer is not keeping up; caller may retry
+
+        object.release();
+        return true;
+    }
+
+    void collectGarbage()
+    {
+        T* object = nullptr;
+        while (retired.pop(object))
+            delete object;
+    }
+
+    // Consumer (audio thread): newest published object, or nullptr if none.
+    // Older objects that were never picked up are retired immediately.
+    T* receive() noexcept
+    {
+        T* newest = nullptr;
+        T* object = nullptr;
+        while (pending.pop(object))
+        {
+            if (newest != nullptr)
+                retire(newest);
+            newest = object;
+        }
+        return newest;
+    }
+
+    // Consumer (audio thread): hand an object back for deletion off the audio thread
+    void retire(T* object) noexcept
+    {
+        if (object != nullptr && !retired.push(object))
+            jassertfalse; // Producer never collects; size the queue for the publish rate
+    }
+
+private:
+    LockFreeFIFO<T*, QUEUE_SIZE> pending;
+    LockFreeFIFO<T*, QUEUE_SIZE * 2> retired;
+
+    JUCE_DECLARE_NON_COPYABLE(RealtimeHandoff)
+};
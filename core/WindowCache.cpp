@@ -0,0 +1,46 @@
+#include "WindowCache.h"
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace
+{
+    // Weak references only: the cache never keeps an entry alive by itself
+    struct Registry
+    {
+        std::mutex lock;
+        std::map<std::pair<WindowType, int>, std::weak_ptr<const std::vector<float>>> windows;
+    };
+
+    Registry& getRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    template <typename Map, typename Key, typename Build>
+    auto findOrBuild (Map& map, const Key& key, Build&& build)
+    {
+        auto& entry = map[key];
+        if (auto existing = entry.lock())
+            return existing;
+
+        // Drop entries whose last owner has gone before adding another
+        for (auto it = map.begin(); it != map.end();)
+            it = it->second.expired() && it->first != key ? map.erase (it) : std::next (it);
+
+        auto created = build();
+        entry = created;
+        return created;
+    }
+}
+
+std::shared_ptr<const std::vector<float>> WindowCache::getWindow (WindowType type, int size)
+{
+    auto& registry = getRegistry();
+    const std::lock_guard<std::mutex> guard (registry.lock);
+    return findOrBuild (registry.windows, std::make_pair (type, size), [type, size]
+    {
+        return std::shared_ptr<const std::vector<float>> (std::make_shared<std::vector<float>> (makeWindow ((size_t) size, type)));
+    });
+}
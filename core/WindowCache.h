@@ -0,0 +1,24 @@
+#pragma once
+#include "Window.h"
+#include <memory>
+#include <vector>
+
+// Process-wide cache of window tables keyed by type and size. Entries are built
+// on first request and shared by reference count, so every processor in the
+// process uses one copy of each; the last owner to let go frees it. Requests are
+// thread-safe but may build under a lock: make them on the message thread, not
+// the audio thread. The tables handed out are never modified, so any number of
+// threads may read them.
+//
+// FFT plans are not shared: juce::dsp::FFT engines may lock inside perform(), so
+// a shared plan would serialise every thread using that size. Each FFTWrapper
+// owns its transform, and that part still scales with the number of instances:
+// the fallback engine keeps roughly 16 bytes per point (twiddles and scratch),
+// so a SpectralProcessor's seven frame orders (256..16384) come to about 0.5 MB,
+// plus a few KB for its low-latency bands, convolver and envelope transforms,
+// and building them takes a few milliseconds per instance.
+class WindowCache
+{
+public:
+    static std::shared_ptr<const std::vector<float>> getWindow (WindowType type, int size);
+};
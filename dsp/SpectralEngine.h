@@ -1,3 +1,41 @@
 #pragma once
 // SpectralEngine.h
-// TODO: Implement in next steps.
+// Block-based STFT mask engine driven by SpectralMaskMsg data.
+#include "../core/FFTWrapper.h"
+#include "../core/AlignedBuffer.h"
+#include "../engine/SpectralMaskField.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class SpectralEngine
+{
+public:
+    void prepare(double sampleRate, int blockSize, int fftOrderIn, int hopSize);
+    void setMask(uint32_t id, const float* data, uint32_t w, uint32_t h);
+    void setScanPosition(float xNorm, float yNorm);
+    void processBlock(float** channels, int numChannels, int numSamples);
+
+private:
+    void applyMask(const PackedSpectrum& spectrum);
+
+    double sr = 44100.0;
+    int block = 0;
+    int hop = 0;
+    int fftSize = 0;
+
+    FFTWrapper fft { 10 };
+    AlignedFloatBuffer frame;           // in-place FFT frame
+    std::vector<float> inputRing;       // mirrored, 2 * fftSize
+    std::vector<float> olaRing;         // fftSize
+    int ringPos = 0;                    // shared by both rings
+    int hopFill = 0;                    // samples into the current hop
+    float olaGain = 1.0f;               // hop / sum(window)
+
+    // Masks are w x h time/frequency fields; scanX picks the column each frame
+    static constexpr int maxMaskBins = (1 << 14) / 2 + 1;
+    static constexpr int minMaskBins = (1 << 6) / 2 + 1;
+    std::unique_ptr<SpectralMaskField> maskField;
+    std::vector<float> binGains;
+    float scanX = 0.0f, scanY = 0.0f;
+};
@@ -19,6 +19,29 @@ void GranularEngine::reset() {
 
 void GranularEngine::setSourceBuffer(const juce::AudioBuffer<float>& source) {
     sourceBuffer = source;
+    writePosition = 0;
+    liveSource = false;
+}
+
+void GranularEngine::writeSource(const float* samples, int numSamples) {
+    const int srcLen = sourceBuffer.getNumSamples();
+    if (srcLen == 0) return;
+    liveSource = true;
+
+    // Only the newest srcLen samples can be kept
+    if (numSamples > srcLen) {
+        samples += numSamples - srcLen;
+        numSamples = srcLen;
+    }
+
+    while (numSamples > 0) {
+        const int n = std::min(numSamples, srcLen - writePosition);
+        for (int ch = 0; ch < sourceBuffer.getNumChannels(); ++ch)
+            sourceBuffer.copyFrom(ch, writePosition, samples, n);
+        writePosition = (writePosition + n) % srcLen;
+        samples += n;
+        numSamples -= n;
+    }
 }
 
 void GranularEngine::process(juce::AudioBuffer<float>& buffer) {
@@ -57,14 +80,25 @@ void GranularEngine::triggerGrain() {
     const float spread = randomness.load() * 0.5f;
     const float pos = posCenter + (rand(rng) - 0.5f) * 2.0f * spread;
 
-    grain->startPos = std::clamp(pos, 0.0f, 1.0f) * sourceBuffer.getNumSamples();
-    grain->position = grain->startPos;
     grain->duration = grainDurationMs.load() * sampleRate / 1000.0f;
 
     // Convert semitones to pitch ratio
     const float semitones = pitchSemitones.load();
     grain->pitch = std::pow(2.0f, semitones / 12.0f);
 
+    const float srcLen = (float)sourceBuffer.getNumSamples();
+    if (liveSource) {
+        // Samples behind the write head: far enough that the grain never reads
+        // past it, near enough that the head does not overwrite what is left to read
+        const float newest = std::min(grain->duration * grain->pitch, srcLen);
+        const float oldest = std::max(newest, srcLen - grain->duration);
+        const float behind = oldest + std::clamp(pos, 0.0f, 1.0f) * (newest - oldest);
+        grain->startPos = std::fmod((float)writePosition - behind + srcLen, srcLen);
+    } else {
+        grain->startPos = std::clamp(pos, 0.0f, 1.0f) * srcLen;
+    }
+    grain->position = grain->startPos;
+
     grain->amplitude = 0.7f;
     grain->pan = rand(rng) * 2.0f - 1.0f; // random pan
     grain->age = 0.0f;
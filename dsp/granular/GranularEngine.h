@@ -24,6 +24,12 @@ public:
 
     void setSourceBuffer(const juce::AudioBuffer<float>& source);
 
+    // Live source (audio thread): appends mono samples to the source buffer,
+    // which is then used as a ring. Grains start behind the newest sample
+    // (position 1 = as recent as the grain allows, 0 = the oldest it can still
+    // read whole), so they replay the last second or so of the input.
+    void writeSource(const float* samples, int numSamples);
+
 private:
     void triggerGrain();
     void processGrain(Grain& grain, float* outL, float* outR, int numSamples);
@@ -40,6 +46,8 @@ private:
     // State
     double sampleRate{ 44100.0 };
     float grainPhase{ 0.0f };
+    int writePosition{ 0 };     // next sample writeSource fills; 0 for a loaded buffer
+    bool liveSource{ false };   // writeSource in use: grains start behind writePosition
     std::mt19937 rng{ 42 };
     std::uniform_real_distribution<float> rand{ 0.0f, 1.0f };
 };
@@ -0,0 +1,201 @@
+// source/engine/AdditiveOscillatorBank.cpp
+#include "AdditiveOscillatorBank.h"
+#include "SpectralKernels.h"
+#include <cmath>
+
+AdditiveOscillatorBank::AdditiveOscillatorBank()
+{
+    constexpr int padded = maxPartials + SpectralKernels::vecSize;
+
+    for (auto* buffer : { &stepRe, &stepIm, &zRe, &zIm, &amplitude, &target,
+                          &packStepRe, &packStepIm, &packRe, &packIm, &packAmp, &packDelta })
+        buffer->allocate((size_t)padded);
+
+    laneSums.allocate((size_t)(subBlock * SpectralKernels::vecSize));
+    active.reserve((size_t)maxPartials);
+    reset();
+}
+
+void AdditiveOscillatorBank::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void AdditiveOscillatorBank::reset()
+{
+    // Spread the start phases (golden-ratio sequence) so the partials do not all
+    // peak together on the first sample
+    for (int p = 0; p < maxPartials; ++p)
+    {
+        const double turns = std::fmod(p * 0.6180339887498949, 1.0);
+        zRe[(size_t)p] = (float)std::cos(juce::MathConstants<double>::twoPi * turns);
+        zIm[(size_t)p] = (float)std::sin(juce::MathConstants<double>::twoPi * turns);
+    }
+
+    amplitude.clear();
+    target.clear();
+    numPartials = 0;
+    numAudible = 0;
+    numActive = 0;
+    rangeChanged = false;
+}
+
+void AdditiveOscillatorBank::setFrequencyRange(float low, float high)
+{
+    if (low == lowHz && high == highHz)
+        return;
+
+    lowHz = juce::jmax(1.0f, juce::jmin(low, high));
+    highHz = juce::jmax(low, high);
+    rangeChanged = true; // re-spread with the next column; until then the old partials fade as usual
+}
+
+void AdditiveOscillatorBank::configure(int partials) noexcept
+{
+    // Log-spaced from lowHz to highHz; phasors carry on so retuning does not click
+    const double ratio = (double)highHz / (double)lowHz;
+    const double nyquist = 0.5 * sampleRate;
+
+    numPartials = partials;
+    numAudible = 0;
+    rangeChanged = false;
+
+    for (int p = 0; p < partials; ++p)
+    {
+        const double f = lowHz * std::pow(ratio, partials > 1 ? (double)p / (partials - 1) : 0.0);
+        if (f >= nyquist)
+            break;
+
+        const double w = juce::MathConstants<double>::twoPi * f / sampleRate;
+        stepRe[(size_t)p] = (float)std::cos(w);
+        stepIm[(size_t)p] = (float)std::sin(w);
+        numAudible = p + 1;
+    }
+
+    for (int p = numAudible; p < maxPartials; ++p)
+        amplitude[(size_t)p] = 0.0f;
+}
+
+void AdditiveOscillatorBank::render(const float* amplitudes, int numRows, float* output, int numSamples) noexcept
+{
+    using Vec = SpectralKernels::Vec;
+    constexpr int vec = SpectralKernels::vecSize;
+
+    juce::FloatVectorOperations::clear(output, numSamples);
+    if (numSamples <= 0)
+        return;
+
+    // Targets for this block, one per partial
+    if (amplitudes != nullptr && numRows > 0)
+    {
+        const int partials = juce::jmin(numRows, maxPartials);
+        if (partials != numPartials || rangeChanged)
+            configure(partials);
+
+        if (numRows <= maxPartials)
+        {
+            juce::FloatVectorOperations::copy(target.data(), amplitudes, partials);
+        }
+        else
+        {
+            for (int p = 0; p < partials; ++p)
+            {
+                const int r0 = (int)((int64_t)p * numRows / partials);
+                const int r1 = (int)((int64_t)(p + 1) * numRows / partials);
+                float sum = 0.0f;
+                for (int r = r0; r < r1; ++r)
+                    sum += amplitudes[r];
+                target[(size_t)p] = sum / (float)(r1 - r0);
+            }
+        }
+    }
+    else
+    {
+        juce::FloatVectorOperations::clear(target.data(), numPartials);
+    }
+
+    // Pack the partials that are audible at either end of the block
+    active.clear();
+    for (int p = 0; p < numAudible; ++p)
+    {
+        if (amplitude[(size_t)p] >= threshold || target[(size_t)p] >= threshold)
+            active.push_back(p);
+        else
+            amplitude[(size_t)p] = target[(size_t)p];
+    }
+
+    numActive = (int)active.size();
+    if (numActive == 0)
+        return;
+
+    const float rampScale = 1.0f / (float)numSamples;
+    for (int i = 0; i < numActive; ++i)
+    {
+        const auto p = (size_t)active[(size_t)i];
+        packStepRe[(size_t)i] = stepRe[p];
+        packStepIm[(size_t)i] = stepIm[p];
+        packRe[(size_t)i] = zRe[p];
+        packIm[(size_t)i] = zIm[p];
+        packAmp[(size_t)i] = amplitude[p];
+        packDelta[(size_t)i] = (target[p] - amplitude[p]) * rampScale;
+    }
+
+    // Silent lanes fill out the last register
+    const int numPacked = SpectralKernels::paddedBins(numActive);
+    for (int i = numActive; i < numPacked; ++i)
+    {
+        packStepRe[(size_t)i] = 1.0f;
+        packStepIm[(size_t)i] = packRe[(size_t)i] = packIm[(size_t)i] = 0.0f;
+        packAmp[(size_t)i] = packDelta[(size_t)i] = 0.0f;
+    }
+
+    // One register of partials at a time with its state in registers: every
+    // sample rotates the phasors, then adds amp * sin into that sample's lanes
+    const float gain = 1.0f / std::sqrt((float)numPartials);
+    float* lanes = laneSums.data();
+
+    for (int start = 0; start < numSamples; start += subBlock)
+    {
+        const int length = juce::jmin(subBlock, numSamples - start);
+        juce::FloatVectorOperations::clear(lanes, length * vec);
+
+        for (int g = 0; g < numPacked; g += vec)
+        {
+            const auto c = Vec::fromRawArray(packStepRe.data() + g);
+            const auto d = Vec::fromRawArray(packStepIm.data() + g);
+            const auto da = Vec::fromRawArray(packDelta.data() + g);
+            auto re = Vec::fromRawArray(packRe.data() + g);
+            auto im = Vec::fromRawArray(packIm.data() + g);
+            auto a = Vec::fromRawArray(packAmp.data() + g);
+
+            for (int s = 0; s < length; ++s)
+            {
+                const auto nextRe = re * c - im * d;
+                im = re * d + im * c;
+                re = nextRe;
+                a += da;
+                (Vec::fromRawArray(lanes + s * vec) + a * im).copyToRawArray(lanes + s * vec);
+            }
+
+            re.copyToRawArray(packRe.data() + g);
+            im.copyToRawArray(packIm.data() + g);
+            a.copyToRawArray(packAmp.data() + g);
+        }
+
+        for (int s = 0; s < length; ++s)
+            output[start + s] = gain * Vec::fromRawArray(lanes + s * vec).sum();
+    }
+
+    // Unpack, pulling each phasor back onto the unit circle (first-order
+    // correction; the drift over one block is tiny)
+    for (int i = 0; i < numActive; ++i)
+    {
+        const auto p = (size_t)active[(size_t)i];
+        const float re = packRe[(size_t)i], im = packIm[(size_t)i];
+        const float k = 1.5f - 0.5f * (re * re + im * im);
+        zRe[p] = re * k;
+        zIm[p] = im * k;
+        amplitude[p] = target[p];
+    }
+}
@@ -0,0 +1,60 @@
+// source/engine/AdditiveOscillatorBank.h
+#pragma once
+#include "../core/AlignedBuffer.h"
+#include <vector>
+
+// Bank of log-spaced sinusoids, one per image row, for turning a picture
+// straight into sound. Each partial is a recursive oscillator (a unit phasor
+// rotated by a fixed step every sample), so a sample costs one complex multiply
+// per partial and no trig. Partials quieter than the threshold are dropped from
+// the block entirely; the rest are packed densely, run a SIMD register at a
+// time with their state held in registers, and ramp linearly to the new
+// amplitudes across the block.
+class AdditiveOscillatorBank
+{
+public:
+    static constexpr int maxPartials = 4096;
+
+    AdditiveOscillatorBank();
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // Lowest and highest partial frequency; partials above Nyquist stay silent
+    void setFrequencyRange(float lowHz, float highHz);
+    void setThreshold(float amplitude) { threshold = amplitude; }
+
+    // Audio thread. amplitudes[numRows] are the targets for this block, lowest
+    // frequency first (nullptr = fade out). Rows beyond maxPartials are averaged
+    // in groups. Writes numSamples to output, scaled by 1/sqrt(partials) so a
+    // full-scale column sums to around unit RMS.
+    void render(const float* amplitudes, int numRows, float* output, int numSamples) noexcept;
+
+    int getActivePartials() const noexcept { return numActive; }
+
+private:
+    void configure(int partials) noexcept;
+
+    static constexpr int subBlock = 256;   // samples per pass; bounds the lane scratch
+
+    double sampleRate = 44100.0;
+    float lowHz = 30.0f, highHz = 16000.0f;
+    float threshold = 1.0e-4f;             // -80 dB
+    int numPartials = 0;                   // configured rows
+    int numAudible = 0;                    // partials below Nyquist (frequencies ascend)
+    int numActive = 0;
+    bool rangeChanged = false;             // configure again on the next column
+
+    // Per partial, indexed by row
+    AlignedFloatBuffer stepRe, stepIm;     // e^{j w}
+    AlignedFloatBuffer zRe, zIm;           // oscillator phasors
+    AlignedFloatBuffer amplitude;          // current (end of last block)
+    AlignedFloatBuffer target;
+
+    // Active partials packed densely for the block, padded to whole registers
+    std::vector<int> active;
+    AlignedFloatBuffer packStepRe, packStepIm, packRe, packIm, packAmp, packDelta;
+    AlignedFloatBuffer laneSums;           // subBlock * vecSize partial sums
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AdditiveOscillatorBank)
+};
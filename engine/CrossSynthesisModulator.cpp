@@ -0,0 +1,54 @@
+// source/engine/CrossSynthesisModulator.cpp
+#include "CrossSynthesisModulator.h"
+#include "SpectralKernels.h"
+#include "../core/FFTWrapper.h"
+#include <cmath>
+#include <vector>
+
+std::unique_ptr<CrossSynthesisModulator> CrossSynthesisModulator::analyse(const float* source, int numSamples, double sourceRate,
+                                                                          double sampleRate, int fftOrder, int hop)
+{
+    if (source == nullptr || numSamples <= 0 || sourceRate <= 0.0 || sampleRate <= 0.0 || hop <= 0)
+        return nullptr;
+
+    FFTWrapper fft(fftOrder);
+    const int fftSize = fft.getSize();
+
+    // Resample to the processing rate, padded so frame t is centred on sample t * hop
+    const double ratio = sourceRate / sampleRate;
+    const int length = juce::jmax(1, (int)std::ceil(numSamples / ratio));
+    const int padding = fftSize / 2;
+
+    std::unique_ptr<CrossSynthesisModulator> result (new CrossSynthesisModulator());
+    result->numBins = fft.getNumBins();
+    result->binStride = SpectralKernels::paddedBins(result->numBins);
+    result->hopSize = hop;
+    result->numFrames = (length + hop - 1) / hop;
+
+    std::vector<float> signal((size_t)(result->numFrames * hop + fftSize), 0.0f);
+    if (ratio == 1.0)
+    {
+        std::copy(source, source + numSamples, signal.begin() + padding);
+    }
+    else
+    {
+        // Whole output samples only, so the interpolator never reads past the source
+        juce::LagrangeInterpolator resampler;
+        resampler.process(ratio, source, signal.data() + padding, (int)(numSamples / ratio));
+    }
+
+    result->magnitudes.allocate((size_t)result->numFrames * (size_t)result->binStride);
+    AlignedFloatBuffer frame ((size_t)fft.getFrameBufferSize());
+
+    for (int t = 0; t < result->numFrames; ++t)
+    {
+        fft.applyWindow(signal.data() + (size_t)t * (size_t)hop, frame.data(), fftSize);
+        const auto spectrum = fft.forwardInPlace(frame.data());
+
+        float* magnitude = result->magnitudes.data() + (size_t)t * (size_t)result->binStride;
+        for (int k = 0; k < result->numBins; ++k)
+            magnitude[k] = std::sqrt(spectrum.re(k) * spectrum.re(k) + spectrum.im(k) * spectrum.im(k));
+    }
+
+    return result;
+}
@@ -0,0 +1,35 @@
+// source/engine/CrossSynthesisModulator.h
+#pragma once
+#include "../core/AlignedBuffer.h"
+#include <memory>
+
+// Magnitude frames of a modulator sample, analysed once on the message thread
+// with the same window, frame size and hop as the live STFT. Playback then
+// only reads one stored frame per hop, so cross-synthesis costs a single live
+// FFT (the carrier's) instead of two.
+class CrossSynthesisModulator
+{
+public:
+    // source: mono, numSamples at sourceRate; resampled to sampleRate first.
+    // Returns nullptr for an empty source.
+    static std::unique_ptr<CrossSynthesisModulator> analyse(const float* source, int numSamples, double sourceRate,
+                                                            double sampleRate, int fftOrder, int hopSize);
+
+    int getNumBins() const noexcept { return numBins; }
+    int getHopSize() const noexcept { return hopSize; }
+    int getNumFrames() const noexcept { return numFrames; }
+
+    // Magnitudes of frame index (0 .. getNumFrames() - 1), numBins values
+    const float* getFrame(int index) const noexcept { return magnitudes.data() + (size_t)index * (size_t)binStride; }
+
+private:
+    CrossSynthesisModulator() = default;
+
+    int numBins = 0;
+    int binStride = 0;
+    int hopSize = 0;
+    int numFrames = 0;
+    AlignedFloatBuffer magnitudes;  // numFrames * binStride
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CrossSynthesisModulator)
+};
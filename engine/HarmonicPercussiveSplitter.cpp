@@ -0,0 +1,133 @@
+// source/engine/HarmonicPercussiveSplitter.cpp
+#include "HarmonicPercussiveSplitter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr int levelsPerOctave = 8;
+    constexpr float lowestOctave = -20.0f;  // level 0 = 2^-20; level 255 ~ 2^12
+
+    // Moves a tracked median so that below <= rank < below + counts[median]
+    template <typename Counts, typename Below>
+    int rebalance(const Counts& counts, int median, Below& below, int rank) noexcept
+    {
+        while (below > rank)
+        {
+            --median;
+            below -= counts[(size_t)median];
+        }
+        while (below + counts[(size_t)median] <= rank)
+        {
+            below += counts[(size_t)median];
+            ++median;
+        }
+        return median;
+    }
+}
+
+void HarmonicPercussiveSplitter::prepare(int bins)
+{
+    maxBins = bins;
+    history.assign((size_t)(maxTimeFrames * maxBins), 0);
+    timeCounts.assign((size_t)maxBins, Histogram {});
+    timeMedian.assign((size_t)maxBins, 0);
+    timeBelow.assign((size_t)maxBins, 0);
+    levels.assign((size_t)maxBins, 0);
+
+    // Soft mask with power 2: H^2 / (H^2 + P^2), by the level difference P - H
+    for (int d = -(numLevels - 1); d < numLevels; ++d)
+        harmonicShare[(size_t)(d + numLevels - 1)] = 1.0f / (1.0f + std::exp2(2.0f * (float)d / (float)levelsPerOctave));
+
+    reset(juce::jmin(maxBins, 1025), 17, 17);
+}
+
+void HarmonicPercussiveSplitter::reset(int bins, int timeFrames, int frequencyBins) noexcept
+{
+    numBins = juce::jlimit(0, maxBins, bins);
+    timeLength = juce::jlimit(1, maxTimeFrames, timeFrames | 1);
+    frequencyHalfWidth = juce::jlimit(0, 255, frequencyBins / 2);
+    historyPos = 0;
+
+    // History starts silent: every bin's window holds timeLength entries at level 0
+    std::fill(history.begin(), history.begin() + timeLength * numBins, (uint8_t)0);
+    for (int k = 0; k < numBins; ++k)
+    {
+        timeCounts[(size_t)k].fill(0);
+        timeCounts[(size_t)k][0] = (uint8_t)timeLength;
+        timeMedian[(size_t)k] = 0;
+        timeBelow[(size_t)k] = 0;
+    }
+}
+
+int HarmonicPercussiveSplitter::quantise(float magnitude) noexcept
+{
+    if (magnitude <= 0.0f)
+        return 0;
+    const float level = (std::log2(magnitude) - lowestOctave) * (float)levelsPerOctave;
+    return juce::jlimit(0, numLevels - 1, (int)(level + 0.5f));
+}
+
+void HarmonicPercussiveSplitter::process(const float* magnitude, float* harmonicGain) noexcept
+{
+    for (int k = 0; k < numBins; ++k)
+        levels[(size_t)k] = (uint8_t)quantise(magnitude[k]);
+
+    // Time median per bin: swap the oldest frame's level for this one's
+    uint8_t* oldest = history.data() + historyPos * numBins;
+    const int timeRank = timeLength / 2;
+    for (int k = 0; k < numBins; ++k)
+    {
+        const int in = levels[(size_t)k], out = oldest[k];
+        oldest[k] = (uint8_t)in;
+        if (in == out)
+            continue;
+
+        auto& counts = timeCounts[(size_t)k];
+        int median = timeMedian[(size_t)k];
+        int below = timeBelow[(size_t)k];
+        --counts[(size_t)out];
+        ++counts[(size_t)in];
+        below += (in < median) - (out < median);
+
+        median = rebalance(counts, median, below, timeRank);
+        timeMedian[(size_t)k] = (uint8_t)median;
+        timeBelow[(size_t)k] = (uint8_t)below;
+    }
+    historyPos = historyPos + 1 < timeLength ? historyPos + 1 : 0;
+
+    // Frequency median within the frame, sliding up the bins (window clipped at the edges)
+    frequencyCounts.fill(0);
+    int count = 0, below = 0, median = 0;
+    for (int k = 0; k <= juce::jmin(frequencyHalfWidth, numBins - 1); ++k)
+    {
+        ++frequencyCounts[levels[(size_t)k]];
+        below += levels[(size_t)k] < median;
+        ++count;
+    }
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        if (k > 0)
+        {
+            const int add = k + frequencyHalfWidth, remove = k - frequencyHalfWidth - 1;
+            if (add < numBins)
+            {
+                ++frequencyCounts[levels[(size_t)add]];
+                below += levels[(size_t)add] < median;
+                ++count;
+            }
+            if (remove >= 0)
+            {
+                --frequencyCounts[levels[(size_t)remove]];
+                below -= levels[(size_t)remove] < median;
+                --count;
+            }
+        }
+
+        median = rebalance(frequencyCounts, median, below, (count - 1) / 2);
+
+        const int difference = median - timeMedian[(size_t)k];
+        harmonicGain[k] = harmonicShare[(size_t)(difference + numLevels - 1)];
+    }
+}
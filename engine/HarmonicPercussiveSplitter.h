@@ -0,0 +1,54 @@
+// source/engine/HarmonicPercussiveSplitter.h
+#pragma once
+#include <juce_core/juce_core.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Streaming harmonic/percussive separation by median filtering: a median
+// across recent frames per bin follows steady (harmonic) energy, a median
+// across neighbouring bins within the frame follows broadband (percussive)
+// energy, and the two give a soft mask per bin. Magnitudes are quantised to
+// 1/8-octave levels and every median is a histogram with a tracked median
+// level, so a window slide is two count updates plus a short walk from the
+// last median: the cost does not grow with the filter lengths. The time
+// median is causal, so the harmonic estimate lags a note onset slightly.
+class HarmonicPercussiveSplitter
+{
+public:
+    static constexpr int maxTimeFrames = 63;
+
+    // Message thread: buffers for frames of up to maxBins bins
+    void prepare(int maxBins);
+
+    // Audio thread (no allocation): restarts with empty history. timeFrames
+    // and frequencyBins are the median lengths, rounded up to odd.
+    void reset(int numBins, int timeFrames, int frequencyBins) noexcept;
+
+    // Audio thread: one frame's magnitudes -> harmonic share per bin (0..1);
+    // the percussive share is 1 - harmonic
+    void process(const float* magnitude, float* harmonicGain) noexcept;
+
+private:
+    static constexpr int numLevels = 256;
+
+    using Histogram = std::array<uint8_t, numLevels>;
+
+    static int quantise(float magnitude) noexcept;
+
+    int numBins = 0;
+    int timeLength = 1;
+    int frequencyHalfWidth = 0;
+    int historyPos = 0;
+
+    std::vector<uint8_t> history;           // timeLength rows of numBins levels, ring
+    std::vector<Histogram> timeCounts;      // per bin
+    std::vector<uint8_t> timeMedian;        // per bin
+    std::vector<uint8_t> timeBelow;         // per bin: entries below timeMedian
+    std::vector<uint8_t> levels;            // this frame, quantised
+    std::array<int, numLevels> frequencyCounts {};
+
+    std::array<float, 2 * numLevels - 1> harmonicShare {}; // by (percussive - harmonic) level
+
+    int maxBins = 0;
+};
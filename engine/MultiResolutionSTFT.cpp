@@ -0,0 +1,198 @@
+// source/engine/MultiResolutionSTFT.cpp
+#include "MultiResolutionSTFT.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    struct BandLayout
+    {
+        int order;
+        int hop;
+    };
+
+    // Highs first. Short frames get 75% overlap, long frames 50%.
+    constexpr BandLayout bandLayouts[MultiResolutionSTFT::numBands] = {
+        { 8,  MultiResolutionSTFT::synthesisHalfLength / 2 },   //  256: above ~2.5 kHz
+        { 10, MultiResolutionSTFT::synthesisHalfLength },       // 1024: ~400 Hz .. 2.5 kHz
+        { 12, MultiResolutionSTFT::synthesisHalfLength },       // 4096: below ~400 Hz
+    };
+
+    // Band edges between consecutive bands (Hz), each faded over one octave
+    constexpr double crossoverFrequencies[MultiResolutionSTFT::numBands - 1] = { 2500.0, 400.0 };
+
+    // Weight of the upper side of a crossover at frequency f; lower side is 1 - this
+    double upperWeight(double f, double crossover)
+    {
+        if (f <= 0.0)
+            return 0.0;
+
+        const double t = juce::jlimit(0.0, 1.0, std::log2(f / crossover) + 0.5);
+        const double s = std::sin(0.5 * juce::MathConstants<double>::pi * t);
+        return s * s;
+    }
+
+    double periodicHann(int n, int length)
+    {
+        return 0.5 - 0.5 * std::cos(2.0 * juce::MathConstants<double>::pi * n / length);
+    }
+}
+
+MultiResolutionSTFT::MultiResolutionSTFT() = default;
+MultiResolutionSTFT::~MultiResolutionSTFT() = default;
+
+void MultiResolutionSTFT::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    constexpr int M = synthesisHalfLength;
+
+    for (int b = 0; b < numBands; ++b)
+    {
+        Band& band = bands[(size_t)b];
+        band.order = bandLayouts[b].order;
+        band.size = 1 << band.order;
+        band.hop = bandLayouts[b].hop;
+        jassert(band.size >= latencySamples && band.size <= maxFrameSize);
+
+        // Hann(2M) summed at hop H gives M / H
+        band.olaGain = (float)band.hop / (float)M;
+
+        if (band.fft == nullptr || band.fft->getSize() != band.size)
+            band.fft = std::make_unique<FFTWrapper>(band.order);
+
+        band.frame.allocate((size_t)band.fft->getFrameBufferSize());
+        band.analysisWindow.allocate((size_t)band.size);
+        band.synthesisWindow.allocate((size_t)latencySamples);
+
+        // Analysis: sqrt-Hann rise over size - M samples, sqrt-Hann(2M) fall over M
+        const int rise = band.size - M;
+        for (int n = 0; n < rise; ++n)
+            band.analysisWindow[(size_t)n] = (float)std::sqrt(periodicHann(n, 2 * rise));
+        for (int n = 0; n < M; ++n)
+            band.analysisWindow[(size_t)(rise + n)] = (float)std::sqrt(periodicHann(M + n, 2 * M));
+
+        // Synthesis over the last 2M samples: analysis * synthesis = Hann(2M)
+        for (int j = 0; j < latencySamples; ++j)
+        {
+            const float a = band.analysisWindow[(size_t)(band.size - latencySamples + j)];
+            band.synthesisWindow[(size_t)j] = a > 1.0e-6f ? (float)periodicHann(j, latencySamples) / a : 0.0f;
+        }
+
+        // Complementary crossover weights evaluated at this band's bin frequencies
+        const int numBins = band.fft->getNumBins();
+        band.crossover.allocate((size_t)numBins);
+        band.firstBin = numBins;
+        band.endBin = 0;
+
+        for (int k = 0; k < numBins; ++k)
+        {
+            const double f = k * sampleRate / band.size;
+            double w = 1.0;
+            for (int c = 0; c < numBands - 1; ++c)
+            {
+                const double upper = upperWeight(f, crossoverFrequencies[c]);
+                if (c < b)
+                    w *= 1.0 - upper;   // below every edge above this band
+                else if (c == b)
+                    w *= upper;         // above the edge below this band
+            }
+
+            band.crossover[(size_t)k] = (float)w;
+            if (w > 0.0)
+            {
+                band.firstBin = juce::jmin(band.firstBin, k);
+                band.endBin = k + 1;
+            }
+        }
+    }
+
+    history.allocate((size_t)(2 * maxFrameSize));
+    outputRing.allocate((size_t)outputRingSize);
+    reset();
+}
+
+void MultiResolutionSTFT::reset() noexcept
+{
+    history.clear();
+    outputRing.clear();
+    historyPos = 0;
+    outputPos = 0;
+
+    for (auto& band : bands)
+        band.hopCounter = 0;
+}
+
+void MultiResolutionSTFT::process(const float* input, float* output, int numSamples,
+                                  const float* mask, int numMaskBins) noexcept
+{
+    if (bands[0].fft == nullptr)
+    {
+        std::fill(output, output + numSamples, 0.0f);
+        return;
+    }
+
+    constexpr int ringMask = outputRingSize - 1;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // Read input first: input and output may be the same buffer
+        const float x = input[i];
+        history[(size_t)historyPos] = x;
+        history[(size_t)(historyPos + maxFrameSize)] = x;
+        historyPos = (historyPos + 1) & (maxFrameSize - 1);
+
+        for (auto& band : bands)
+        {
+            if (++band.hopCounter == band.hop)
+            {
+                band.hopCounter = 0;
+                processBand(band, mask, numMaskBins);
+            }
+        }
+
+        // Every frame that overlaps this sample has been added by now
+        float& y = outputRing[(size_t)((outputPos - latencySamples) & ringMask)];
+        output[i] = y;
+        y = 0.0f;
+        outputPos = (outputPos + 1) & ringMask;
+    }
+}
+
+void MultiResolutionSTFT::processBand(Band& band, const float* mask, int numMaskBins) noexcept
+{
+    // Mirrored history: the newest 'size' samples are contiguous
+    const float* recent = history.data() + historyPos + maxFrameSize - band.size;
+    float* frame = band.frame.data();
+    juce::FloatVectorOperations::multiply(frame, recent, band.analysisWindow.data(), band.size);
+
+    const PackedSpectrum spectrum = band.fft->forwardInPlace(frame);
+
+    // Crossover weight times the mask, sampled at this band's bin frequencies
+    const float maskScale = (float)(numMaskBins - 1) / (float)(spectrum.numBins - 1);
+    std::fill(frame, frame + 2 * band.firstBin, 0.0f);
+    for (int k = band.firstBin; k < band.endBin; ++k)
+    {
+        float gain = band.crossover[(size_t)k];
+        if (mask != nullptr)
+        {
+            const float pos = (float)k * maskScale;
+            const int m0 = (int)pos;
+            const int m1 = juce::jmin(m0 + 1, numMaskBins - 1);
+            gain *= mask[m0] + (pos - (float)m0) * (mask[m1] - mask[m0]);
+        }
+        spectrum.re(k) *= gain;
+        spectrum.im(k) *= gain;
+    }
+    std::fill(frame + 2 * band.endBin, frame + 2 * spectrum.numBins, 0.0f);
+
+    band.fft->inverseInPlace(frame);
+
+    // Only the last 2M samples survive the synthesis window; they cover the
+    // 2M output samples ending at the newest input sample (outputPos)
+    const float* tail = frame + band.size - latencySamples;
+    constexpr int ringMask = outputRingSize - 1;
+    const int start = (outputPos + 1 - latencySamples) & ringMask;
+    for (int j = 0; j < latencySamples; ++j)
+        outputRing[(size_t)((start + j) & ringMask)] += tail[j] * band.synthesisWindow[(size_t)j] * band.olaGain;
+}
@@ -0,0 +1,67 @@
+// source/engine/MultiResolutionSTFT.h
+#pragma once
+#include "../core/FFTWrapper.h"
+#include "../core/AlignedBuffer.h"
+#include <array>
+#include <memory>
+
+// Low-latency multi-resolution STFT for spectral masking.
+// The spectrum is split into bands: short frames for the highs, long frames
+// for the lows, each with its own hop. Every band uses an asymmetric analysis
+// window (long rise, short fall) paired with a synthesis window that is only
+// 2 * M samples long, so all bands come out time-aligned with a total latency
+// of 2 * M samples while the low band keeps its long-frame frequency resolution.
+// Complementary raised-cosine crossovers make the bands sum to unity.
+class MultiResolutionSTFT
+{
+public:
+    static constexpr int numBands = 3;
+    static constexpr int synthesisHalfLength = 64;            // M; latency = 2 * M
+    static constexpr int latencySamples = 2 * synthesisHalfLength;
+
+    MultiResolutionSTFT();
+    ~MultiResolutionSTFT();
+
+    // Message thread. Crossovers depend on the sample rate.
+    void prepare(double sampleRate);
+    void reset() noexcept;
+
+    // Audio thread. 'mask' holds numMaskBins gains spread evenly from DC to
+    // Nyquist; each band samples it at its own bin frequencies.
+    void process(const float* input, float* output, int numSamples,
+                 const float* mask, int numMaskBins) noexcept;
+
+    int getLatencySamples() const noexcept { return latencySamples; }
+
+private:
+    struct Band
+    {
+        int order = 0;
+        int size = 0;
+        int hop = 0;
+        int firstBin = 0, endBin = 0;       // bins with non-zero crossover weight
+        float olaGain = 1.0f;
+        int hopCounter = 0;
+        std::unique_ptr<FFTWrapper> fft;
+        AlignedFloatBuffer analysisWindow;  // size samples
+        AlignedFloatBuffer synthesisWindow; // latencySamples, aligned to the frame end
+        AlignedFloatBuffer crossover;       // per-bin band weight
+        AlignedFloatBuffer frame;
+    };
+
+    void processBand(Band& band, const float* mask, int numMaskBins) noexcept;
+
+    std::array<Band, numBands> bands;
+
+    static constexpr int maxFrameSize = 4096;
+    static constexpr int outputRingSize = 4 * synthesisHalfLength;
+
+    AlignedFloatBuffer history;             // mirrored: every sample stored at pos and pos + maxFrameSize
+    AlignedFloatBuffer outputRing;
+    int historyPos = 0;
+    int outputPos = 0;                      // ring index of the current sample
+
+    double sampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultiResolutionSTFT)
+};
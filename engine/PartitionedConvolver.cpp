@@ -0,0 +1,283 @@
+// source/engine/PartitionedConvolver.cpp
+#include "PartitionedConvolver.h"
+#include "SpectralKernels.h"
+#include <algorithm>
+#include <cmath>
+
+PartitionedConvolver::PartitionedConvolver() = default;
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    delete current;
+    delete previous;
+}
+
+void PartitionedConvolver::prepare(double newSampleRate, int partitionSize, double maxImpulseSeconds)
+{
+    jassert(juce::isPowerOfTwo(partitionSize));
+
+    sampleRate = newSampleRate;
+    blockSize = partitionSize;
+    numBins = blockSize + 1;
+    binStride = SpectralKernels::paddedBins(numBins);
+    maxPartitions = juce::jmax(1, (int)std::ceil(maxImpulseSeconds * sampleRate / blockSize));
+    fadeBlocks = juce::jmax(1, juce::roundToInt(0.02 * sampleRate / blockSize)); // ~20 ms
+
+    int order = 0;
+    while ((1 << order) < 2 * blockSize)
+        ++order;
+    fft = std::make_unique<FFTWrapper>(order);
+
+    frame.allocate((size_t)fft->getFrameBufferSize());
+    inputHistory.allocate((size_t)(2 * blockSize));
+    outputBlock.allocate((size_t)blockSize);
+    fadeBlock.allocate((size_t)blockSize);
+    delayLineRe.allocate((size_t)(maxPartitions * binStride));
+    delayLineIm.allocate((size_t)(maxPartitions * binStride));
+    accRe.allocate((size_t)binStride);
+    accIm.allocate((size_t)binStride);
+
+    // Audio is stopped while preparing, so this thread may act as the consumer.
+    // Anything still queued was partitioned for the old block size.
+    delete handoff.receive();
+    handoff.collectGarbage();
+    delete current;
+    delete previous;
+    current = previous = nullptr;
+
+    if (!lastImpulse.empty())
+        current = buildImpulse(lastImpulse.data(), (int)lastImpulse.size()).release();
+
+    reset();
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+    inputHistory.clear();
+    outputBlock.clear();
+    delayLineRe.clear();
+    delayLineIm.clear();
+    delayLineHead = 0;
+    blockPos = 0;
+
+    if (previous != nullptr)
+    {
+        handoff.retire(previous);
+        previous = nullptr;
+    }
+}
+
+std::unique_ptr<PartitionedConvolver::Impulse> PartitionedConvolver::buildImpulse(const float* impulse, int length) const
+{
+    auto ir = std::make_unique<Impulse>();
+    ir->numPartitions = juce::jlimit(1, maxPartitions, (length + blockSize - 1) / blockSize);
+    ir->re.allocate((size_t)(ir->numPartitions * binStride));
+    ir->im.allocate((size_t)(ir->numPartitions * binStride));
+
+    // Own transform and frame: sharing the audio thread's FFT would make it contend
+    // with this (possibly long) build on every block
+    FFTWrapper partitionFFT(fft->getOrder());
+    AlignedFloatBuffer partitionFrame((size_t)partitionFFT.getFrameBufferSize());
+
+    for (int p = 0; p < ir->numPartitions; ++p)
+    {
+        partitionFrame.clear();
+        const int offset = p * blockSize;
+        const int count = juce::jmin(blockSize, length - offset);
+        if (count > 0)
+            std::copy(impulse + offset, impulse + offset + count, partitionFrame.data());
+
+        partitionFFT.forwardInPlace(partitionFrame.data());
+        SpectralKernels::deinterleave(partitionFrame.data(),
+                                      ir->re.data() + p * binStride,
+                                      ir->im.data() + p * binStride,
+                                      numBins);
+    }
+
+    return ir;
+}
+
+bool PartitionedConvolver::loadImpulse(const float* impulse, int length)
+{
+    if (fft == nullptr || impulse == nullptr || length <= 0)
+        return false;
+
+    // Only a response the audio thread will receive is rebuilt on the next prepare
+    if (!handoff.publish(buildImpulse(impulse, length)))
+        return false;
+
+    lastImpulse.assign(impulse, impulse + length);
+    return true;
+}
+
+bool PartitionedConvolver::loadImpulse(const juce::AudioBuffer<float>& impulse, double impulseSampleRate)
+{
+    const int numChannels = impulse.getNumChannels();
+    const int sourceLength = impulse.getNumSamples();
+    if (numChannels == 0 || sourceLength == 0 || impulseSampleRate <= 0.0)
+        return false;
+
+    // Mono sum, linearly resampled to the engine rate
+    const double ratio = impulseSampleRate / sampleRate;
+    const int length = juce::jmax(1, (int)(sourceLength / ratio));
+    std::vector<float> mono((size_t)length, 0.0f);
+    const float channelGain = 1.0f / (float)numChannels;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* src = impulse.getReadPointer(ch);
+        for (int i = 0; i < length; ++i)
+        {
+            const double pos = i * ratio;
+            const int i0 = (int)pos;
+            const int i1 = juce::jmin(i0 + 1, sourceLength - 1);
+            const float frac = (float)(pos - i0);
+            mono[(size_t)i] += channelGain * (src[i0] + frac * (src[i1] - src[i0]));
+        }
+    }
+
+    return loadImpulse(mono.data(), length);
+}
+
+bool PartitionedConvolver::loadImpulseFromSpectrum(const float* magnitudes, int numMagnitudes, int impulseLength)
+{
+    if (magnitudes == nullptr || numMagnitudes <= 0)
+        return false;
+
+    const int length = juce::nextPowerOfTwo(juce::jmax(64, impulseLength));
+    int order = 0;
+    while ((1 << order) < length)
+        ++order;
+
+    FFTWrapper design(order);
+    AlignedFloatBuffer designFrame((size_t)design.getFrameBufferSize());
+    const PackedSpectrum spectrum { designFrame.data(), design.getNumBins() };
+
+    // Zero-phase response interpolated from the magnitude curve
+    for (int k = 0; k < spectrum.numBins; ++k)
+    {
+        const float pos = (float)k * (numMagnitudes - 1) / (float)(spectrum.numBins - 1);
+        const int i0 = (int)pos;
+        const int i1 = juce::jmin(i0 + 1, numMagnitudes - 1);
+        spectrum.re(k) = magnitudes[i0] + (pos - i0) * (magnitudes[i1] - magnitudes[i0]);
+        spectrum.im(k) = 0.0f;
+    }
+    design.inverseInPlace(designFrame.data());
+
+    // Centre the symmetric response and taper it -> linear-phase FIR
+    std::vector<float> fir((size_t)length);
+    const float* window = design.getWindow();
+    for (int n = 0; n < length; ++n)
+        fir[(size_t)n] = designFrame[(size_t)((n + length / 2) % length)] * window[n];
+
+    return loadImpulse(fir.data(), length);
+}
+
+void PartitionedConvolver::process(const float* input, float* output, int numSamples) noexcept
+{
+    if (fft == nullptr)
+    {
+        std::fill(output, output + numSamples, 0.0f);
+        return;
+    }
+
+    int done = 0;
+    while (done < numSamples)
+    {
+        const int chunk = juce::jmin(numSamples - done, blockSize - blockPos);
+
+        // Input first: input and output may be the same buffer
+        std::copy(input + done, input + done + chunk, inputHistory.data() + blockSize + blockPos);
+        std::copy(outputBlock.data() + blockPos, outputBlock.data() + blockPos + chunk, output + done);
+
+        blockPos += chunk;
+        done += chunk;
+
+        if (blockPos == blockSize)
+        {
+            processBlock();
+            blockPos = 0;
+        }
+    }
+}
+
+void PartitionedConvolver::processBlock() noexcept
+{
+    // Pick up a freshly prepared response; the one playing now fades out
+    if (auto* incoming = handoff.receive())
+    {
+        handoff.retire(previous); // a fade still running is cut short
+        previous = current;
+        current = incoming;
+        fadeBlocksDone = 0;
+    }
+
+    // Newest input spectrum -> head of the frequency-domain delay line
+    delayLineHead = (delayLineHead + 1) % maxPartitions;
+    std::copy(inputHistory.data(), inputHistory.data() + 2 * blockSize, frame.data());
+    fft->forwardInPlace(frame.data());
+    SpectralKernels::deinterleave(frame.data(),
+                                  delayLineRe.data() + delayLineHead * binStride,
+                                  delayLineIm.data() + delayLineHead * binStride,
+                                  numBins);
+    std::copy(inputHistory.data() + blockSize, inputHistory.data() + 2 * blockSize, inputHistory.data());
+
+    if (current != nullptr)
+    {
+        accumulate(*current, accRe.data(), accIm.data());
+        renderAccumulator(accRe.data(), accIm.data(), outputBlock.data());
+    }
+    else
+    {
+        outputBlock.clear();
+    }
+
+    if (previous != nullptr)
+    {
+        accumulate(*previous, accRe.data(), accIm.data());
+        renderAccumulator(accRe.data(), accIm.data(), fadeBlock.data());
+
+        // Linear crossfade from the outgoing response over fadeBlocks blocks
+        const float g0 = (float)fadeBlocksDone / (float)fadeBlocks;
+        const float step = 1.0f / (float)(fadeBlocks * blockSize);
+        for (int i = 0; i < blockSize; ++i)
+        {
+            const float g = g0 + step * (float)i;
+            outputBlock[(size_t)i] = fadeBlock[(size_t)i] + g * (outputBlock[(size_t)i] - fadeBlock[(size_t)i]);
+        }
+
+        if (++fadeBlocksDone >= fadeBlocks)
+        {
+            handoff.retire(previous);
+            previous = nullptr;
+        }
+    }
+}
+
+void PartitionedConvolver::accumulate(const Impulse& ir, float* re, float* im) const noexcept
+{
+    std::fill(re, re + binStride, 0.0f);
+    std::fill(im, im + binStride, 0.0f);
+
+    // Partition p meets the input spectrum from p blocks ago
+    int slot = delayLineHead;
+    for (int p = 0; p < ir.numPartitions; ++p)
+    {
+        SpectralKernels::complexMultiplyAccumulate(re, im,
+                                                   delayLineRe.data() + slot * binStride,
+                                                   delayLineIm.data() + slot * binStride,
+                                                   ir.re.data() + p * binStride,
+                                                   ir.im.data() + p * binStride,
+                                                   numBins);
+        slot = (slot == 0 ? maxPartitions : slot) - 1;
+    }
+}
+
+void PartitionedConvolver::renderAccumulator(const float* re, const float* im, float* dest) noexcept
+{
+    SpectralKernels::interleave(re, im, frame.data(), numBins);
+    fft->inverseInPlace(frame.data());
+
+    // Overlap-save: the second half of the circular result is the valid block
+    std::copy(frame.data() + blockSize, frame.data() + 2 * blockSize, dest);
+}
@@ -0,0 +1,79 @@
+// source/engine/PartitionedConvolver.h
+#pragma once
+#include "../core/FFTWrapper.h"
+#include "../core/AlignedBuffer.h"
+#include "../core/RealtimeHandoff.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <memory>
+#include <vector>
+
+// Uniformly partitioned overlap-save convolver.
+// The impulse response is cut into blocks of partitionSize, each transformed
+// once (off the audio thread); the audio thread keeps a frequency-domain delay
+// line of input spectra and multiply-accumulates it against the partitions.
+// Latency is one partition. Impulse swaps are crossfaded over a few blocks.
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver();
+    ~PartitionedConvolver();
+
+    // Message thread. Allocates the delay line for up to maxImpulseSeconds.
+    void prepare(double sampleRate, int partitionSize, double maxImpulseSeconds = 10.0);
+    void reset() noexcept;
+
+    // Message/background thread: partitions and transforms the response, then
+    // hands it to the audio thread. Returns false if the handoff queue is full.
+    bool loadImpulse(const float* impulse, int length);
+    bool loadImpulse(const juce::AudioBuffer<float>& impulse, double impulseSampleRate);
+
+    // Image-derived response: magnitudes (0..1, low -> high frequency) become a
+    // linear-phase FIR of impulseLength samples.
+    bool loadImpulseFromSpectrum(const float* magnitudes, int numMagnitudes, int impulseLength);
+
+    // Audio thread
+    void process(const float* input, float* output, int numSamples) noexcept;
+
+    int getLatencySamples() const noexcept { return blockSize; }
+    bool hasImpulse() const noexcept { return current != nullptr; }
+
+private:
+    // Transformed partitions of one response, split re/im, paddedBins apart
+    struct Impulse
+    {
+        int numPartitions = 0;
+        AlignedFloatBuffer re, im;
+    };
+
+    std::unique_ptr<Impulse> buildImpulse(const float* impulse, int length) const;
+    void processBlock() noexcept;
+    void accumulate(const Impulse& ir, float* accRe, float* accIm) const noexcept;
+    void renderAccumulator(const float* accRe, const float* accIm, float* dest) noexcept;
+
+    double sampleRate = 44100.0;
+    int blockSize = 0;
+    int numBins = 0;
+    int binStride = 0;
+    int maxPartitions = 0;
+
+    std::unique_ptr<FFTWrapper> fft;    // 2 * blockSize, audio thread only; impulse builds use their own
+    AlignedFloatBuffer frame;           // audio-thread FFT frame
+    AlignedFloatBuffer inputHistory;    // [previous block | current block]
+    AlignedFloatBuffer outputBlock;
+    AlignedFloatBuffer fadeBlock;       // output of the outgoing response while crossfading
+    AlignedFloatBuffer delayLineRe, delayLineIm;  // frequency-domain delay line
+    AlignedFloatBuffer accRe, accIm;
+    int delayLineHead = 0;
+    int blockPos = 0;
+
+    // Crossfade state
+    RealtimeHandoff<Impulse> handoff;
+    Impulse* current = nullptr;
+    Impulse* previous = nullptr;
+    int fadeBlocks = 1;
+    int fadeBlocksDone = 0;
+
+    std::vector<float> lastImpulse;     // message thread copy, re-partitioned on prepare
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
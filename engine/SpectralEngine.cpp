@@ -1,6 +1,7 @@
 // source/engine/SpectralEngine.cpp
 #include "SpectralEngine.h"
 #include "SpectralProcessor.h" // Include SpectralProcessor to use its functionality
+#include "SampleManager.h"
 #include <algorithm>
 #include <cmath>
 
@@ -42,6 +43,11 @@ public:
         spectralProcessor.process(inputChannelData, outputChannelData, numSamples);
     }
 
+    void process(const float* inputChannelData, float* outputChannelData, float* percussiveChannelData, int numSamples)
+    {
+        spectralProcessor.process(inputChannelData, outputChannelData, numSamples, percussiveChannelData);
+    }
+
     void setMode(ProcessingMode newMode)
     {
         // Map SpectralEngine's mode to SpectralProcessor's mode
@@ -51,14 +57,75 @@ public:
             case ProcessingMode::FrequencyMask:spectralProcessor.setMode(SpectralProcessor::Mode::FrequencyMask); break;
             case ProcessingMode::SpectralBlur: spectralProcessor.setMode(SpectralProcessor::Mode::SpectralBlur); break;
             case ProcessingMode::SpectralFreeze:spectralProcessor.setMode(SpectralProcessor::Mode::SpectralFreeze); break;
-            // case ProcessingMode::Convolution: // Add handling for convolution if implemented in SpectralProcessor
+            case ProcessingMode::Convolution:  spectralProcessor.setMode(SpectralProcessor::Mode::Convolution); break;
+            case ProcessingMode::LowLatencyMask:spectralProcessor.setMode(SpectralProcessor::Mode::LowLatencyMask); break;
+            case ProcessingMode::Additive:     spectralProcessor.setMode(SpectralProcessor::Mode::Additive); break;
+            case ProcessingMode::CrossSynthesis:spectralProcessor.setMode(SpectralProcessor::Mode::CrossSynthesis); break;
+            case ProcessingMode::HarmonicPercussive:spectralProcessor.setMode(SpectralProcessor::Mode::HarmonicPercussive); break;
             default:                           spectralProcessor.setMode(SpectralProcessor::Mode::Bypass); break;
         }
     }
 
+    void setFrameSize(int numSamples)
+    {
+        spectralProcessor.setFrameSize(numSamples);
+    }
+
+    void setOverlap(int framesPerWindow)
+    {
+        spectralProcessor.setOverlap(framesPerWindow);
+    }
+
+    void setBackgroundProcessing(bool enabled)
+    {
+        spectralProcessor.setBackgroundProcessing(enabled);
+    }
+
+    int getLatencySamples() const
+    {
+        return spectralProcessor.getLatencySamples();
+    }
+
+    SpectrumTap& getSpectrumTap()
+    {
+        return spectralProcessor.getSpectrumTap();
+    }
+
     void applyMask(const std::vector<float>& maskData, int width, int height)
     {
-        spectralProcessor.applyImageMask(maskData, width, height); // Assumed to be the same as applyImageMask
+        spectralProcessor.applyImageMask(maskData, width, height);
+    }
+
+    void setScanPosition(float x)
+    {
+        spectralProcessor.setScanPosition(x);
+    }
+
+    void setScanRate(float widthsPerSecond)
+    {
+        spectralProcessor.setScanRate(widthsPerSecond);
+    }
+
+    void setFrequencyScale(FrequencyScale scale)
+    {
+        using Scale = SpectralMaskField::FrequencyScale;
+        switch (scale)
+        {
+            case FrequencyScale::Linear:    spectralProcessor.setFrequencyScale(Scale::Linear); break;
+            case FrequencyScale::Mel:       spectralProcessor.setFrequencyScale(Scale::Mel); break;
+            case FrequencyScale::Log:       spectralProcessor.setFrequencyScale(Scale::Log); break;
+            case FrequencyScale::ConstantQ: spectralProcessor.setFrequencyScale(Scale::ConstantQ); break;
+        }
+    }
+
+    void setMaskSlew(float milliseconds)
+    {
+        spectralProcessor.setMaskSlew(milliseconds);
+    }
+
+    void setAdditiveRange(float lowHz, float highHz)
+    {
+        spectralProcessor.setAdditiveRange(lowHz, highHz);
     }
 
     void setSpectralBlur(float amount)
@@ -66,11 +133,31 @@ public:
         spectralProcessor.setBlurAmount(amount);
     }
 
+    void setTemporalBlur(float amount)
+    {
+        spectralProcessor.setTemporalBlur(amount);
+    }
+
     void setFreezeEnabled(bool enabled)
     {
         spectralProcessor.setFreezeEnabled(enabled);
     }
 
+    void captureFreezeSlot(int slot)
+    {
+        spectralProcessor.captureFreezeSlot(slot);
+    }
+
+    void recallFreezeSlot(int slot)
+    {
+        spectralProcessor.recallFreezeSlot(slot);
+    }
+
+    void setFreezeFadeTime(float milliseconds)
+    {
+        spectralProcessor.setFreezeFadeTime(milliseconds);
+    }
+
     void setPitchShift(float semitones)
     {
         spectralProcessor.setPitchShift(semitones);
@@ -81,6 +168,36 @@ public:
         spectralProcessor.setFormantShift(amount);
     }
 
+    bool loadImpulseResponse(const SampleManager& samples, int slot)
+    {
+        const auto* buffer = samples.getSample(slot);
+        const auto* info = samples.getSampleInfo(slot);
+        if (buffer == nullptr || info == nullptr)
+            return false;
+
+        return spectralProcessor.setConvolutionImpulse(*buffer, info->sampleRate);
+    }
+
+    bool setConvolutionSpectrum(const std::vector<float>& magnitudes)
+    {
+        return spectralProcessor.setConvolutionSpectrum(magnitudes);
+    }
+
+    bool loadCrossSynthesisModulator(const SampleManager& samples, int slot)
+    {
+        const auto* buffer = samples.getSample(slot);
+        const auto* info = samples.getSampleInfo(slot);
+        if (buffer == nullptr || info == nullptr)
+            return false;
+
+        return spectralProcessor.setCrossSynthesisModulator(*buffer, info->sampleRate);
+    }
+
+    void setCrossSynthesisAmount(float amount)
+    {
+        spectralProcessor.setCrossSynthesisAmount(amount);
+    }
+
 private:
     SpectralProcessor spectralProcessor; // The actual processor
 };
@@ -109,26 +226,101 @@ void SpectralEngine::process(const float* inputChannelData, float* outputChannel
     impl->process(inputChannelData, outputChannelData, numSamples);
 }
 
+void SpectralEngine::process(const float* inputChannelData, float* outputChannelData, float* percussiveChannelData, int numSamples)
+{
+    impl->process(inputChannelData, outputChannelData, percussiveChannelData, numSamples);
+}
+
 void SpectralEngine::setMode(ProcessingMode mode)
 {
     impl->setMode(mode);
 }
 
+void SpectralEngine::setFrameSize(int numSamples)
+{
+    impl->setFrameSize(numSamples);
+}
+
+void SpectralEngine::setOverlap(int framesPerWindow)
+{
+    impl->setOverlap(framesPerWindow);
+}
+
+void SpectralEngine::setBackgroundProcessing(bool enabled)
+{
+    impl->setBackgroundProcessing(enabled);
+}
+
+int SpectralEngine::getLatencySamples() const
+{
+    return impl->getLatencySamples();
+}
+
+SpectrumTap& SpectralEngine::getSpectrumTap()
+{
+    return impl->getSpectrumTap();
+}
+
 void SpectralEngine::applyMask(const std::vector<float>& maskData, int width, int height)
 {
     impl->applyMask(maskData, width, height);
 }
 
+void SpectralEngine::setScanPosition(float x)
+{
+    impl->setScanPosition(x);
+}
+
+void SpectralEngine::setScanRate(float widthsPerSecond)
+{
+    impl->setScanRate(widthsPerSecond);
+}
+
+void SpectralEngine::setFrequencyScale(FrequencyScale scale)
+{
+    impl->setFrequencyScale(scale);
+}
+
+void SpectralEngine::setMaskSlew(float milliseconds)
+{
+    impl->setMaskSlew(milliseconds);
+}
+
+void SpectralEngine::setAdditiveRange(float lowHz, float highHz)
+{
+    impl->setAdditiveRange(lowHz, highHz);
+}
+
 void SpectralEngine::setSpectralBlur(float amount)
 {
     impl->setSpectralBlur(amount);
 }
 
+void SpectralEngine::setTemporalBlur(float amount)
+{
+    impl->setTemporalBlur(amount);
+}
+
 void SpectralEngine::setFreezeEnabled(bool enabled)
 {
     impl->setFreezeEnabled(enabled);
 }
 
+void SpectralEngine::captureFreezeSlot(int slot)
+{
+    impl->captureFreezeSlot(slot);
+}
+
+void SpectralEngine::recallFreezeSlot(int slot)
+{
+    impl->recallFreezeSlot(slot);
+}
+
+void SpectralEngine::setFreezeFadeTime(float milliseconds)
+{
+    impl->setFreezeFadeTime(milliseconds);
+}
+
 void SpectralEngine::setPitchShift(float semitones)
 {
     impl->setPitchShift(semitones);
@@ -137,4 +329,24 @@ void SpectralEngine::setPitchShift(float semitones)
 void SpectralEngine::setFormantShift(float amount)
 {
     impl->setFormantShift(amount);
+}
+
+bool SpectralEngine::loadImpulseResponse(const SampleManager& samples, int slot)
+{
+    return impl->loadImpulseResponse(samples, slot);
+}
+
+bool SpectralEngine::setConvolutionSpectrum(const std::vector<float>& magnitudes)
+{
+    return impl->setConvolutionSpectrum(magnitudes);
+}
+
+bool SpectralEngine::loadCrossSynthesisModulator(const SampleManager& samples, int slot)
+{
+    return impl->loadCrossSynthesisModulator(samples, slot);
+}
+
+void SpectralEngine::setCrossSynthesisAmount(float amount)
+{
+    impl->setCrossSynthesisAmount(amount);
 }
\ No newline at end of file
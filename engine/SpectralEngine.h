@@ -4,6 +4,9 @@
 #include <vector>
 #include <memory>
 
+class SampleManager;
+class SpectrumTap;
+
 class SpectralEngine
 {
 public:
@@ -17,6 +20,8 @@ public:
     // Processing methods
     void process(juce::AudioBuffer<float>& buffer);
     void process(const float* inputChannelData, float* outputChannelData, int numSamples);
+    // As above; percussiveChannelData receives the percussive part in HarmonicPercussive mode
+    void process(const float* inputChannelData, float* outputChannelData, float* percussiveChannelData, int numSamples);
 
     // Processing modes
     enum class ProcessingMode
@@ -25,18 +30,58 @@ public:
         FrequencyMask,
         SpectralBlur,
         SpectralFreeze,
-        Convolution
+        Convolution,
+        LowLatencyMask,     // band-split STFT, latency fixed at 128 samples
+        Additive,           // image rows played as an oscillator bank, input ignored
+        CrossSynthesis,     // input shaped by the magnitudes of a SampleManager slot
+        HarmonicPercussive  // harmonic part (masked) to the output, percussive part to a second output
     };
     
     void setMode(ProcessingMode mode);
+
+    // Analysis frame (256..16384 samples) and overlap; switching never allocates
+    void setFrameSize(int numSamples);
+    void setOverlap(int framesPerWindow);
+    void setBackgroundProcessing(bool enabled);   // frames on a worker thread, +1 hop latency; applied at prepareToPlay
+    int getLatencySamples() const;
+    SpectrumTap& getSpectrumTap();                 // processed frames for displays (SpectrogramComponent)
     
     // Spectral effects controls
     void applyMask(const std::vector<float>& maskData, int width, int height);
+    void setScanPosition(float x);
+    void setScanRate(float widthsPerSecond);
+
+    // Image row -> frequency layout of masks
+    enum class FrequencyScale
+    {
+        Linear,
+        Mel,
+        Log,
+        ConstantQ
+    };
+
+    void setFrequencyScale(FrequencyScale scale);
+    void setMaskSlew(float milliseconds);
+    void setAdditiveRange(float lowHz, float highHz);
     void setSpectralBlur(float amount);
+    void setTemporalBlur(float amount);
     void setFreezeEnabled(bool enabled);
+    void captureFreezeSlot(int slot);
+    void recallFreezeSlot(int slot);        // -1 returns to the live input
+    void setFreezeFadeTime(float milliseconds);
     void setPitchShift(float semitones);
     void setFormantShift(float amount);
 
+    // Convolution impulse from a SampleManager slot or an image-derived spectrum.
+    // Call from the message thread; the swap is crossfaded on the audio thread.
+    bool loadImpulseResponse(const SampleManager& samples, int slot);
+    bool setConvolutionSpectrum(const std::vector<float>& magnitudes);
+
+    // Cross-synthesis modulator from a SampleManager slot (message thread; analysed
+    // here once, so playback runs a single live FFT per hop)
+    bool loadCrossSynthesisModulator(const SampleManager& samples, int slot);
+    void setCrossSynthesisAmount(float amount);
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl;
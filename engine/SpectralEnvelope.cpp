@@ -0,0 +1,108 @@
+// source/engine/SpectralEnvelope.cpp
+#include "SpectralEnvelope.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float logFloor = -20.7f; // ln(1e-9)
+}
+
+SpectralEnvelope::SpectralEnvelope()
+{
+    frame.allocate((size_t)fft.getFrameBufferSize());
+    prepare(sampleRate, fft.getNumBins());
+}
+
+void SpectralEnvelope::prepare(double newSampleRate, int maxBins)
+{
+    sampleRate = newSampleRate;
+
+    const auto points = (size_t)fft.getNumBins();
+    pooled.assign(points, 0.0f);
+    reference.assign(points, 0.0f);
+    target.assign(points, 0.0f);
+    smoothed.assign(points, 0.0f);
+    envelope.assign((size_t)juce::jmax(maxBins, (int)points), 0.0f);
+    reset();
+}
+
+void SpectralEnvelope::reset() noexcept
+{
+    envelopeBins = 0;
+    hopsSinceUpdate = 0;
+}
+
+void SpectralEnvelope::smooth(const float* logSpectrum, float* out, int points) noexcept
+{
+    // The log spectrum is real and even, so its cepstrum is one real inverse FFT
+    const int size = 2 * (points - 1);
+    float* data = frame.data();
+    for (int j = 0; j < points; ++j)
+    {
+        data[2 * j] = logSpectrum[j];
+        data[2 * j + 1] = 0.0f;
+    }
+    fft.inverseInPlace(data);
+
+    // Lifter: keep quefrencies below ~1.5 ms, under the period of all but very high voices
+    const int cutoff = juce::jlimit(4, size / 2 - 1, (int)(sampleRate * 0.0015));
+    std::fill(data + cutoff + 1, data + size - cutoff, 0.0f);
+
+    const auto spectrum = fft.forwardInPlace(data);
+    for (int j = 0; j < points; ++j)
+        out[j] = spectrum.re(j);
+}
+
+bool SpectralEnvelope::update(const float* magnitude, int numBins) noexcept
+{
+    const int points = fft.getNumBins();
+    if (numBins < 2 || numBins > (int)envelope.size())
+        return false;
+
+    // Peak-pool the bins onto the cepstrum grid (or spread them if the frame is smaller)
+    const float binsPerPoint = (float)(numBins - 1) / (float)(points - 1);
+    for (int j = 0; j < points; ++j)
+    {
+        const int lo = juce::jlimit(0, numBins - 1, (int)std::ceil((j - 0.5f) * binsPerPoint));
+        const int hi = juce::jlimit(lo, numBins - 1, (int)std::floor((j + 0.5f) * binsPerPoint));
+        float peak = magnitude[lo];
+        for (int k = lo + 1; k <= hi; ++k)
+            peak = juce::jmax(peak, magnitude[k]);
+        pooled[(size_t)j] = peak > 1.0e-9f ? std::log(peak) : logFloor;
+    }
+
+    // Keep the cached envelope while the spectrum has hardly moved
+    if (envelopeBins == numBins && ++hopsSinceUpdate < maxCachedHops)
+    {
+        float distance = 0.0f;
+        for (int j = 0; j < points; ++j)
+            distance += std::abs(pooled[(size_t)j] - reference[(size_t)j]);
+        if (distance < stationaryDistance * (float)points)
+            return false;
+    }
+
+    // True envelope: re-smooth the spectrum lifted to the previous estimate, so
+    // the curve climbs onto the peaks instead of averaging into the valleys
+    std::copy(pooled.begin(), pooled.end(), target.begin());
+    for (int iteration = 0; iteration < trueEnvelopeIterations; ++iteration)
+    {
+        smooth(target.data(), smoothed.data(), points);
+        for (int j = 0; j < points; ++j)
+            target[(size_t)j] = juce::jmax(pooled[(size_t)j], smoothed[(size_t)j]);
+    }
+
+    // Back to one value per bin
+    for (int k = 0; k < numBins; ++k)
+    {
+        const float position = (float)k / binsPerPoint;
+        const int j = juce::jmin((int)position, points - 2);
+        const float frac = position - (float)j;
+        envelope[(size_t)k] = smoothed[(size_t)j] + frac * (smoothed[(size_t)j + 1] - smoothed[(size_t)j]);
+    }
+
+    std::copy(pooled.begin(), pooled.end(), reference.begin());
+    envelopeBins = numBins;
+    hopsSinceUpdate = 0;
+    return true;
+}
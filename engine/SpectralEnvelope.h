@@ -0,0 +1,49 @@
+// source/engine/SpectralEnvelope.h
+#pragma once
+#include "../core/FFTWrapper.h"
+#include "../core/AlignedBuffer.h"
+#include <vector>
+
+// Spectral envelope estimate for formant processing. The log magnitude is
+// peak-pooled down to a short spectrum and smoothed by liftering its cepstrum
+// with a small real FFT (256 points whatever the frame size), iterated a few
+// times towards the true envelope so it rides on the harmonic peaks rather
+// than between them. While the input is stationary the last envelope is kept
+// and only re-estimated every few hops.
+class SpectralEnvelope
+{
+public:
+    SpectralEnvelope();
+
+    // Message thread: sizes buffers for frames of up to maxBins bins
+    void prepare(double sampleRate, int maxBins);
+    void reset() noexcept;
+
+    // Audio thread. Feeds one frame's magnitudes; returns true when the
+    // envelope was re-estimated (false = the cached one still stands).
+    bool update(const float* magnitude, int numBins) noexcept;
+
+    // Natural-log envelope, one value per bin of the last update
+    const float* getLogEnvelope() const noexcept { return envelope.data(); }
+
+private:
+    static constexpr int cepstrumOrder = 8;        // 256-point cepstrum
+    static constexpr int trueEnvelopeIterations = 3;
+    static constexpr int maxCachedHops = 4;        // re-estimate at least this often
+    static constexpr float stationaryDistance = 0.35f; // mean |log difference| (~3 dB)
+
+    void smooth(const float* logSpectrum, float* smoothed, int points) noexcept;
+
+    double sampleRate = 44100.0;
+    FFTWrapper fft { cepstrumOrder };
+    AlignedFloatBuffer frame;
+
+    std::vector<float> pooled;      // log spectrum at the cepstrum resolution
+    std::vector<float> reference;   // pooled spectrum the cached envelope came from
+    std::vector<float> target;      // true-envelope iteration input
+    std::vector<float> smoothed;
+    std::vector<float> envelope;    // upsampled to numBins
+
+    int envelopeBins = 0;           // 0 = nothing cached
+    int hopsSinceUpdate = 0;
+};
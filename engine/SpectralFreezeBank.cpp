@@ -0,0 +1,182 @@
+// source/engine/SpectralFreezeBank.cpp
+#include "SpectralFreezeBank.h"
+#include "SpectralKernels.h"
+#include <cmath>
+
+namespace
+{
+    float wrapPhase(float x) noexcept
+    {
+        const float twoPi = juce::MathConstants<float>::twoPi;
+        return x - twoPi * std::round(x / twoPi);
+    }
+}
+
+SpectralFreezeBank::SpectralFreezeBank() = default;
+
+void SpectralFreezeBank::prepare(int maxBins)
+{
+    binStride = SpectralKernels::paddedBins(maxBins);
+
+    for (auto& slot : slots)
+    {
+        slot.numBins = 0;
+        slot.magnitude.allocate((size_t)binStride);
+        slot.stepRe.allocate((size_t)binStride);
+        slot.stepIm.allocate((size_t)binStride);
+        slot.startRe.allocate((size_t)binStride);
+        slot.startIm.allocate((size_t)binStride);
+    }
+
+    for (auto& voice : voices)
+    {
+        voice.re.allocate((size_t)binStride);
+        voice.im.allocate((size_t)binStride);
+    }
+
+    accRe.allocate((size_t)binStride);
+    accIm.allocate((size_t)binStride);
+    numBins = 0;
+    reset(maxBins);
+}
+
+void SpectralFreezeBank::reset(int frameBins) noexcept
+{
+    if (frameBins != numBins)
+        for (auto& slot : slots)
+            slot.numBins = 0;
+
+    numBins = frameBins;
+    for (auto& voice : voices)
+        voice.slot = live;
+    fading = false;
+}
+
+bool SpectralFreezeBank::hasSlot(int slot) const noexcept
+{
+    return slot >= 0 && slot < numSlots && slots[(size_t)slot].numBins == numBins;
+}
+
+bool SpectralFreezeBank::needsLiveInput() const noexcept
+{
+    return voices[(size_t)currentVoice].slot == live
+        || (fading && voices[(size_t)(1 - currentVoice)].slot == live);
+}
+
+bool SpectralFreezeBank::isFrozen() const noexcept
+{
+    return voices[(size_t)currentVoice].slot != live
+        || (fading && voices[(size_t)(1 - currentVoice)].slot != live);
+}
+
+void SpectralFreezeBank::capture(int slotIndex, const float* magnitude, const float* phase,
+                                 const float* prevPhase, int frameBins, float binAdvance) noexcept
+{
+    if (slotIndex < 0 || slotIndex >= numSlots || frameBins != numBins)
+        return;
+
+    Slot& slot = slots[(size_t)slotIndex];
+    juce::FloatVectorOperations::copy(slot.magnitude.data(), magnitude, frameBins);
+
+    // True frequency of each bin -> phase advance per hop, stored as a phasor so
+    // playback never needs trig
+    for (int k = 0; k < frameBins; ++k)
+    {
+        const float expected = binAdvance * (float)k;
+        const float advance = expected + wrapPhase(phase[k] - prevPhase[k] - expected);
+        slot.stepRe[(size_t)k] = std::cos(advance);
+        slot.stepIm[(size_t)k] = std::sin(advance);
+        slot.startRe[(size_t)k] = std::cos(phase[k]);
+        slot.startIm[(size_t)k] = std::sin(phase[k]);
+    }
+    slot.numBins = frameBins;
+}
+
+void SpectralFreezeBank::recall(int slotIndex, int newFadeHops) noexcept
+{
+    if (slotIndex != live && !hasSlot(slotIndex))
+        return;
+
+    if (slotIndex == voices[(size_t)currentVoice].slot && !fading)
+        return;
+
+    // The voice playing now becomes the one fading out; a fade still running is cut short
+    currentVoice = 1 - currentVoice;
+    Voice& voice = voices[(size_t)currentVoice];
+    voice.slot = slotIndex;
+    if (slotIndex != live)
+    {
+        const Slot& slot = slots[(size_t)slotIndex];
+        juce::FloatVectorOperations::copy(voice.re.data(), slot.startRe.data(), numBins);
+        juce::FloatVectorOperations::copy(voice.im.data(), slot.startIm.data(), numBins);
+    }
+
+    fading = true;
+    fadeHops = juce::jmax(1, newFadeHops);
+    fadeHopsDone = 0;
+}
+
+void SpectralFreezeBank::render(const PackedSpectrum& spectrum) noexcept
+{
+    if (!isFrozen() || spectrum.numBins != numBins)
+        return;
+
+    juce::FloatVectorOperations::clear(accRe.data(), numBins);
+    juce::FloatVectorOperations::clear(accIm.data(), numBins);
+
+    // Equal-gain crossfade, one step per hop; overlap-add smooths the steps
+    const float gain = fading ? (float)(fadeHopsDone + 1) / (float)fadeHops : 1.0f;
+    addVoice(voices[(size_t)currentVoice], gain, spectrum);
+    if (fading)
+        addVoice(voices[(size_t)(1 - currentVoice)], 1.0f - gain, spectrum);
+
+    SpectralKernels::interleave(accRe.data(), accIm.data(), spectrum.data, numBins);
+
+    if (fading && ++fadeHopsDone >= fadeHops)
+        fading = false;
+
+    // Rounding slowly pulls the phasors off the unit circle
+    if (++hopsSinceRenormalise >= 256)
+    {
+        hopsSinceRenormalise = 0;
+        for (auto& voice : voices)
+            if (voice.slot != live)
+                renormalise(voice);
+    }
+}
+
+void SpectralFreezeBank::addVoice(Voice& voice, float gain, const PackedSpectrum& spectrum) noexcept
+{
+    if (gain <= 0.0f)
+        return;
+
+    if (voice.slot == live)
+    {
+        for (int k = 0; k < numBins; ++k)
+        {
+            accRe[(size_t)k] += gain * spectrum.re(k);
+            accIm[(size_t)k] += gain * spectrum.im(k);
+        }
+        return;
+    }
+
+    const Slot& slot = slots[(size_t)voice.slot];
+    if (slot.numBins != numBins)
+        return;
+
+    SpectralKernels::rotateAccumulate(accRe.data(), accIm.data(),
+                                      voice.re.data(), voice.im.data(),
+                                      slot.stepRe.data(), slot.stepIm.data(),
+                                      slot.magnitude.data(), gain, numBins);
+}
+
+void SpectralFreezeBank::renormalise(Voice& voice) noexcept
+{
+    for (int k = 0; k < numBins; ++k)
+    {
+        const float re = voice.re[(size_t)k], im = voice.im[(size_t)k];
+        const float scale = 1.0f / std::sqrt(re * re + im * im + 1.0e-30f);
+        voice.re[(size_t)k] = re * scale;
+        voice.im[(size_t)k] = im * scale;
+    }
+}
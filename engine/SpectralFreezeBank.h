@@ -0,0 +1,76 @@
+// source/engine/SpectralFreezeBank.h
+#pragma once
+#include "../core/FFTWrapper.h"
+#include "../core/AlignedBuffer.h"
+#include <array>
+
+// Bank of frozen spectral frames.
+// A slot stores the magnitudes of one analysis frame plus, per bin, the phase
+// advance per hop measured from two consecutive frames (as a unit phasor).
+// Recalled slots are resynthesised as a bank of complex oscillators: one
+// complex multiply per bin per hop, no trig and no forward FFT. Two voices
+// allow crossfading between slots, or between a slot and the live spectrum.
+// All memory is allocated in prepare(); everything else is audio-thread safe.
+class SpectralFreezeBank
+{
+public:
+    static constexpr int numSlots = 8;
+    static constexpr int live = -1;         // "slot" meaning the unfrozen input
+
+    SpectralFreezeBank();
+
+    // Message thread
+    void prepare(int maxBins);
+
+    // Audio thread. Stops playback; captured slots survive only if the bin
+    // count stays the same.
+    void reset(int frameBins) noexcept;
+
+    // Stores one frame. phase/prevPhase are the analysis phases of this frame
+    // and the previous one; binAdvance is the expected phase advance of bin 1.
+    void capture(int slot, const float* magnitude, const float* phase, const float* prevPhase,
+                 int frameBins, float binAdvance) noexcept;
+
+    // Crossfades to a slot (or 'live') over fadeHops frames. Empty slots are ignored.
+    void recall(int slot, int fadeHops) noexcept;
+
+    bool hasSlot(int slot) const noexcept;
+    bool needsLiveInput() const noexcept;
+    bool isFrozen() const noexcept;
+
+    // Writes the next frame into 'spectrum'. If needsLiveInput(), it must hold
+    // the live analysis of this frame on entry.
+    void render(const PackedSpectrum& spectrum) noexcept;
+
+private:
+    struct Slot
+    {
+        int numBins = 0;                    // 0 = empty
+        AlignedFloatBuffer magnitude;
+        AlignedFloatBuffer stepRe, stepIm;  // phase advance per hop
+        AlignedFloatBuffer startRe, startIm;// phase at capture
+    };
+
+    struct Voice
+    {
+        int slot = live;
+        AlignedFloatBuffer re, im;          // running oscillator phasors
+    };
+
+    void addVoice(Voice& voice, float gain, const PackedSpectrum& spectrum) noexcept;
+    void renormalise(Voice& voice) noexcept;
+
+    std::array<Slot, numSlots> slots;
+    std::array<Voice, 2> voices;            // the other voice fades out while voices[currentVoice] fades in
+    int currentVoice = 0;
+    bool fading = false;
+    AlignedFloatBuffer accRe, accIm;
+
+    int binStride = 0;
+    int numBins = 0;
+    int fadeHops = 1;
+    int fadeHopsDone = 0;
+    int hopsSinceRenormalise = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectralFreezeBank)
+};
@@ -0,0 +1,101 @@
+// source/engine/SpectralKernels.h
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+
+// Small SIMD kernels shared by the spectral processors. Spectra are stored
+// split (separate re/im arrays) so that every lane does the same work.
+// Pointers should come from AlignedFloatBuffer; loads fall back to scalar
+// for the tail that does not fill a whole register.
+namespace SpectralKernels
+{
+    using Vec = juce::dsp::SIMDRegister<float>;
+    constexpr int vecSize = (int)Vec::SIZE;
+
+    // Rounds a bin count up so each split spectrum starts on a register boundary
+    inline int paddedBins(int numBins) noexcept
+    {
+        return (numBins + vecSize - 1) / vecSize * vecSize;
+    }
+
+    // acc += x * h (complex, split layout)
+    inline void complexMultiplyAccumulate(float* accRe, float* accIm,
+                                          const float* xRe, const float* xIm,
+                                          const float* hRe, const float* hIm,
+                                          int numBins) noexcept
+    {
+        int k = 0;
+        for (; k + vecSize <= numBins; k += vecSize)
+        {
+            const auto a = Vec::fromRawArray(xRe + k), b = Vec::fromRawArray(xIm + k);
+            const auto c = Vec::fromRawArray(hRe + k), d = Vec::fromRawArray(hIm + k);
+            (Vec::fromRawArray(accRe + k) + (a * c - b * d)).copyToRawArray(accRe + k);
+            (Vec::fromRawArray(accIm + k) + (a * d + b * c)).copyToRawArray(accIm + k);
+        }
+        for (; k < numBins; ++k)
+        {
+            accRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+            accIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+        }
+    }
+
+    // Oscillator bank step: z *= step (unit phasors), then acc += gain * mag * z
+    inline void rotateAccumulate(float* accRe, float* accIm,
+                                 float* zRe, float* zIm,
+                                 const float* stepRe, const float* stepIm,
+                                 const float* mag, float gain, int numBins) noexcept
+    {
+        const auto g = Vec::expand(gain);
+        int k = 0;
+        for (; k + vecSize <= numBins; k += vecSize)
+        {
+            const auto a = Vec::fromRawArray(zRe + k), b = Vec::fromRawArray(zIm + k);
+            const auto c = Vec::fromRawArray(stepRe + k), d = Vec::fromRawArray(stepIm + k);
+            const auto re = a * c - b * d;
+            const auto im = a * d + b * c;
+            re.copyToRawArray(zRe + k);
+            im.copyToRawArray(zIm + k);
+
+            const auto m = Vec::fromRawArray(mag + k) * g;
+            (Vec::fromRawArray(accRe + k) + m * re).copyToRawArray(accRe + k);
+            (Vec::fromRawArray(accIm + k) + m * im).copyToRawArray(accIm + k);
+        }
+        for (; k < numBins; ++k)
+        {
+            const float re = zRe[k] * stepRe[k] - zIm[k] * stepIm[k];
+            const float im = zRe[k] * stepIm[k] + zIm[k] * stepRe[k];
+            zRe[k] = re;
+            zIm[k] = im;
+            accRe[k] += gain * mag[k] * re;
+            accIm[k] += gain * mag[k] * im;
+        }
+    }
+
+    // Sum of a[i] * b[i]; both aligned, n a multiple of vecSize
+    inline float dot(const float* a, const float* b, int n) noexcept
+    {
+        auto acc = Vec::expand(0.0f);
+        for (int i = 0; i < n; i += vecSize)
+            acc += Vec::fromRawArray(a + i) * Vec::fromRawArray(b + i);
+        return acc.sum();
+    }
+
+    // Packed [re, im, re, im, ...] -> split re[] / im[]
+    inline void deinterleave(const float* packed, float* re, float* im, int numBins) noexcept
+    {
+        for (int k = 0; k < numBins; ++k)
+        {
+            re[k] = packed[2 * k];
+            im[k] = packed[2 * k + 1];
+        }
+    }
+
+    // Split re[] / im[] -> packed [re, im, re, im, ...]
+    inline void interleave(const float* re, const float* im, float* packed, int numBins) noexcept
+    {
+        for (int k = 0; k < numBins; ++k)
+        {
+            packed[2 * k]     = re[k];
+            packed[2 * k + 1] = im[k];
+        }
+    }
+}
@@ -0,0 +1,226 @@
+// source/engine/SpectralMaskField.cpp
+#include "SpectralMaskField.h"
+#include "SpectralKernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double logMinFrequency = 20.0;
+    constexpr double constantQMinFrequency = 32.703; // C1
+
+    double hzToMel(double f) { return 2595.0 * std::log10(1.0 + f / 700.0); }
+}
+
+SpectralMaskField::SpectralMaskField(int w, int h, const Mapping& m)
+    : width(juce::jmax(1, w)),
+      height(juce::jmax(1, h)),
+      columnStride(SpectralKernels::paddedBins(juce::jmax(1, h))),
+      mapping(m)
+{
+    columns.allocate((size_t)(width * columnStride));
+    column.allocate((size_t)columnStride);
+
+    for (int bins = mapping.maxBins; bins >= juce::jmax(2, mapping.minBins); bins = (bins - 1) / 2 + 1)
+    {
+        tables.push_back(std::make_unique<BinWeights>());
+        buildWeights(*tables.back(), bins);
+        if (bins == 2)
+            break;
+    }
+}
+
+std::unique_ptr<SpectralMaskField> SpectralMaskField::fromImage(const float* brightness, int w, int h, const Mapping& m)
+{
+    if (brightness == nullptr || w <= 0 || h <= 0 || m.maxBins < 2)
+        return nullptr;
+
+    std::unique_ptr<SpectralMaskField> field (new SpectralMaskField(w, h, m));
+
+    // Transpose to column-major and flip so row 0 is the lowest frequency
+    for (int y = 0; y < h; ++y)
+    {
+        const float* src = brightness + (size_t)y * (size_t)w;
+        const int row = h - 1 - y;
+        for (int x = 0; x < w; ++x)
+            field->columns[(size_t)(x * field->columnStride + row)] = src[x];
+    }
+
+    return field;
+}
+
+std::unique_ptr<SpectralMaskField> SpectralMaskField::fromCurve(const float* curve, int length, const Mapping& m)
+{
+    if (curve == nullptr || length <= 0 || m.maxBins < 2)
+        return nullptr;
+
+    std::unique_ptr<SpectralMaskField> field (new SpectralMaskField(1, length, m));
+    std::copy(curve, curve + length, field->columns.data());
+    return field;
+}
+
+float SpectralMaskField::rowPosition(double frequency) const noexcept
+{
+    const double nyquist = 0.5 * mapping.sampleRate;
+    const double f = juce::jlimit(0.0, nyquist, frequency);
+    double t = 0.0;
+
+    switch (mapping.scale)
+    {
+        case FrequencyScale::Linear:
+            t = f / nyquist;
+            break;
+        case FrequencyScale::Mel:
+            t = hzToMel(f) / hzToMel(nyquist);
+            break;
+        case FrequencyScale::Log:
+            t = f > logMinFrequency ? std::log2(f / logMinFrequency) / std::log2(nyquist / logMinFrequency) : 0.0;
+            break;
+        case FrequencyScale::ConstantQ:
+            t = f > constantQMinFrequency ? std::log2(f / constantQMinFrequency) / std::log2(nyquist / constantQMinFrequency) : 0.0;
+            break;
+    }
+
+    return (float)(juce::jlimit(0.0, 1.0, t) * (height - 1));
+}
+
+void SpectralMaskField::buildWeights(BinWeights& table, int numBins) const
+{
+    constexpr int vec = SpectralKernels::vecSize;
+    const double nyquist = 0.5 * mapping.sampleRate;
+    const double binWidth = nyquist / (numBins - 1);
+
+    // Constant Q: row r is centred on fmin * 2^(r / rowsPerOctave), width = spacing to the next row
+    const double rowsPerOctave = height > 1 ? (height - 1) / std::log2(nyquist / constantQMinFrequency) : 1.0;
+    const double bandRatio = std::pow(2.0, 1.0 / rowsPerOctave) - 1.0;
+
+    table.numBins = numBins;
+    table.runStart.resize((size_t)numBins);
+    table.runLength.resize((size_t)numBins);
+    table.weightOffset.resize((size_t)numBins);
+
+    std::vector<float> packed;
+    std::vector<float> run((size_t)height);
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const double f = k * binWidth;
+        int first = 0, last = 0;
+
+        if (height == 1)
+        {
+            run[0] = 1.0f;
+        }
+        else if (mapping.scale == FrequencyScale::ConstantQ)
+        {
+            // Triangular band per row, never narrower than a bin so low rows are averaged, not skipped
+            first = juce::jmax(0, (int)std::floor(rowPosition(juce::jmin(f - binWidth, f / (1.0 + bandRatio)))));
+            last = juce::jmin(height - 1, (int)std::ceil(rowPosition(juce::jmax(f + binWidth, bandRatio < 1.0 ? f / (1.0 - bandRatio) : nyquist))));
+
+            float sum = 0.0f;
+            for (int r = first; r <= last; ++r)
+            {
+                const double centre = constantQMinFrequency * std::pow(2.0, r / rowsPerOctave);
+                const double halfWidth = juce::jmax(centre * bandRatio, binWidth);
+                const float w = (float)juce::jmax(0.0, 1.0 - std::abs(f - centre) / halfWidth);
+                run[(size_t)(r - first)] = w;
+                sum += w;
+            }
+
+            if (sum > 0.0f)
+            {
+                // Trim rows the triangles did not reach
+                int i0 = 0, i1 = last - first;
+                while (run[(size_t)i0] == 0.0f) ++i0;
+                while (run[(size_t)i1] == 0.0f) --i1;
+                for (int i = i0; i <= i1; ++i)
+                    run[(size_t)(i - i0)] = run[(size_t)i] / sum;
+                last = first + i1;
+                first += i0;
+            }
+            else
+            {
+                first = last = juce::roundToInt(rowPosition(f));
+                run[0] = 1.0f;
+            }
+        }
+        else
+        {
+            const float lo = rowPosition(f - 0.5 * binWidth);
+            const float hi = rowPosition(f + 0.5 * binWidth);
+
+            if (hi - lo <= 1.0f)
+            {
+                // Fewer rows than bins here: interpolate between the two nearest rows
+                const float pos = rowPosition(f);
+                first = juce::jmin((int)pos, height - 1);
+                last = juce::jmin(first + 1, height - 1);
+                const float frac = pos - (float)first;
+                run[0] = 1.0f - frac;
+                if (last > first)
+                    run[1] = frac;
+                else
+                    run[0] = 1.0f;
+            }
+            else
+            {
+                // Several rows fall into this bin: average them
+                first = juce::jlimit(0, height - 1, (int)std::ceil(lo));
+                last = juce::jlimit(first, height - 1, (int)std::floor(hi));
+                const float w = 1.0f / (float)(last - first + 1);
+                std::fill(run.begin(), run.begin() + (last - first + 1), w);
+            }
+        }
+
+        // Widen to aligned whole registers; columnStride is a register multiple
+        const int start = first / vec * vec;
+        const int end = (last + 1 + vec - 1) / vec * vec;
+        table.runStart[(size_t)k] = start;
+        table.runLength[(size_t)k] = end - start;
+        table.weightOffset[(size_t)k] = (int)packed.size();
+
+        const size_t base = packed.size();
+        packed.resize(base + (size_t)(end - start), 0.0f);
+        std::copy(run.begin(), run.begin() + (last - first + 1), packed.begin() + (ptrdiff_t)(base + (size_t)(first - start)));
+    }
+
+    table.weights.allocate(packed.size());
+    std::copy(packed.begin(), packed.end(), table.weights.data());
+}
+
+const float* SpectralMaskField::blendColumn(float x) noexcept
+{
+    // Blend the two columns either side of the scan position (contiguous, vectorised)
+    const float pos = juce::jlimit(0.0f, 1.0f, x) * (float)(width - 1);
+    const int c0 = juce::jmin((int)pos, width - 1);
+    const int c1 = juce::jmin(c0 + 1, width - 1);
+    const float frac = pos - (float)c0;
+
+    float* blended = column.data();
+    const float* col0 = columns.data() + c0 * columnStride;
+    const float* col1 = columns.data() + c1 * columnStride;
+    juce::FloatVectorOperations::multiply(blended, col0, 1.0f - frac, height);
+    juce::FloatVectorOperations::addWithMultiply(blended, col1, frac, height);
+    return blended;
+}
+
+void SpectralMaskField::renderColumn(float x, float* destBins, int numBins) noexcept
+{
+    const BinWeights* table = nullptr;
+    for (const auto& t : tables)
+        if (t->numBins == numBins)
+            table = t.get();
+
+    jassert(table != nullptr); // frame size outside the range given to the mapping
+    if (table == nullptr)
+        return;
+
+    const float* blended = blendColumn(x);
+
+    // Sparse row -> bin product: one aligned dot product per bin
+    const float* weights = table->weights.data();
+    for (int k = 0; k < numBins; ++k)
+        destBins[k] = SpectralKernels::dot(weights + table->weightOffset[(size_t)k],
+                                           blended + table->runStart[(size_t)k],
+                                           table->runLength[(size_t)k]);
+}
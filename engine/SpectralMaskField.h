@@ -0,0 +1,77 @@
+// source/engine/SpectralMaskField.h
+#pragma once
+#include "../core/AlignedBuffer.h"
+#include <memory>
+#include <vector>
+
+// Two-dimensional time/frequency gain field built from an image.
+// Columns are time, rows are frequency (top row = highest frequency, as the
+// image is drawn). Built once on the message thread: the pixels are stored
+// column-major so one column is contiguous, and the row -> bin weights are
+// precomputed for every frame size. Per hop the audio thread only blends two
+// neighbouring columns and runs a sparse matrix-vector product onto the bins,
+// independent of image width.
+class SpectralMaskField
+{
+public:
+    // How image rows are spread over frequency
+    enum class FrequencyScale
+    {
+        Linear,     // DC .. Nyquist, evenly
+        Mel,        // mel scale from DC
+        Log,        // equal rows per octave from 20 Hz
+        ConstantQ   // log-spaced from 32.7 Hz (C1), each row a band of constant Q
+    };
+
+    struct Mapping
+    {
+        FrequencyScale scale = FrequencyScale::Linear;
+        double sampleRate = 44100.0;
+        int maxBins = 0;        // bins of the largest frame
+        int minBins = 0;        // bins of the smallest frame; weights are built for every power of two between
+    };
+
+    // brightness: width * height values, row-major, row 0 at the top
+    static std::unique_ptr<SpectralMaskField> fromImage(const float* brightness, int width, int height, const Mapping& mapping);
+
+    // A single column; curve[0] is the lowest frequency
+    static std::unique_ptr<SpectralMaskField> fromCurve(const float* curve, int length, const Mapping& mapping);
+
+    int getWidth() const noexcept { return width; }
+    int getHeight() const noexcept { return height; }
+
+    // Audio thread. Writes the column at scan position x (0..1, interpolated
+    // between neighbouring columns) into numBins gains. numBins must be one of
+    // the frame sizes covered by the mapping.
+    void renderColumn(float x, float* destBins, int numBins) noexcept;
+
+    // Audio thread. The raw rows at scan position x, lowest frequency first:
+    // getHeight() values, valid until the next call on this field.
+    const float* blendColumn(float x) noexcept;
+
+private:
+    // Row -> bin weights for one frame size, in CSR form. Each bin reads one
+    // contiguous run of rows; runs are widened to whole SIMD registers on
+    // aligned boundaries (zero weights) so the product never needs unaligned loads.
+    struct BinWeights
+    {
+        int numBins = 0;
+        std::vector<int> runStart, runLength, weightOffset;
+        AlignedFloatBuffer weights;
+    };
+
+    SpectralMaskField(int width, int height, const Mapping& mapping);
+    void buildWeights(BinWeights& table, int numBins) const;
+    float rowPosition(double frequency) const noexcept;
+
+    int width = 0;
+    int height = 0;
+    int columnStride = 0;
+    Mapping mapping;
+
+    AlignedFloatBuffer columns;     // column-major, lowest frequency first, columnStride apart (zero padded)
+    AlignedFloatBuffer column;      // audio-thread scratch: the blended column
+    std::vector<std::unique_ptr<BinWeights>> tables; // [0] = maxBins, then halving
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectralMaskField)
+};
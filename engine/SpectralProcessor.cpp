@@ -1,234 +1,930 @@
 // source/engine/SpectralProcessor.cpp
 #include "SpectralProcessor.h"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <numeric>
 
 SpectralProcessor::SpectralProcessor()
 {
-    fft = std::make_unique<FFTWrapper>(fftOrder);
+    // Build every plan/window now so size changes never allocate on the audio thread
+    for (int i = 0; i < numFrameOrders; ++i)
+    {
+        fftPlans[(size_t)i] = std::make_unique<FFTWrapper>(minFrameOrder + i);
+        
+        // The inverse transform is already normalised, so the only OLA gain left is
+        // the window overlap: sum over frames of w(n - k*hop) ~= sum(w) / hop.
+        const int size = fftPlans[(size_t)i]->getSize();
+        const float* window = fftPlans[(size_t)i]->getWindow();
+        windowSums[(size_t)i] = std::accumulate(window, window + size, 0.0f);
+    }
     
-    // Allocate buffers
-    inputBuffer.resize(fftSize);
-    outputBuffer.resize(fftSize);
-    fftData.resize(fftSize);                // now holds time-domain after inverse
-    magnitude.resize(fftSize / 2 + 1);
-    phase.resize(fftSize / 2 + 1);
-    prevPhase.resize(fftSize / 2 + 1);
-    phaseAccum.resize(fftSize / 2 + 1);
-    spectralMask.resize(fftSize / 2 + 1, 1.0f);
+    // Allocate buffers for the largest frame
+    inputBuffer.resize(2 * maxFFTSize, 0.0f);
+    outputBuffer.resize(maxFFTSize, 0.0f);
+    fftFrame.allocate((size_t)(2 * maxFFTSize));
+    jobInput.allocate((size_t)maxFFTSize);
+    jobFrame.allocate((size_t)(2 * maxFFTSize));
+    sideFrame.allocate((size_t)(2 * maxFFTSize));
+    jobSideFrame.allocate((size_t)(2 * maxFFTSize));
+    percussiveBuffer.resize(maxFFTSize, 0.0f);
+    magnitude.resize(maxBins);
+    phase.resize(maxBins);
+    prevPhase.resize(maxBins, 0.0f);
+    phaseAccum.resize(maxBins, 0.0f);
+    blurScratch.resize(maxBins, 0.0f);
+    blurHistory.resize(maxBins, 0.0f);
+    shiftedMagnitude.resize(maxBins, 0.0f);
+    shiftedPhase.resize(maxBins, 0.0f);
+    peakBins.resize(maxBins / 2 + 1, 0);
+    spectralMask.resize(maxBins, 1.0f);
+    targetMask.resize(maxBins, 1.0f);
+    maskDelta.resize(maxBins, 0.0f);
+    maskRunStart.resize(maxBins / 2 + 1, 0);
+    maskRunEnd.resize(maxBins / 2 + 1, 0);
+    freezeBank.prepare(maxBins);
+    formantGain.resize(maxBins, 1.0f);
+    harmonicGain.resize(maxBins, 1.0f);
+    splitter.prepare(maxBins);
+    formantEnvelope.prepare(sampleRate, maxBins);
     
-    // Initialize buffers
-    std::fill(inputBuffer.begin(), inputBuffer.end(), 0.0f);
-    std::fill(outputBuffer.begin(), outputBuffer.end(), 0.0f);
-    std::fill(prevPhase.begin(), prevPhase.end(), 0.0f);
-    std::fill(phaseAccum.begin(), phaseAccum.end(), 0.0f);
+    applyFrameConfig(defaultFrameOrder, defaultOverlap);
+    
+    // Prepared up front so impulses can be loaded before the host calls prepareToPlay
+    convolver.prepare(sampleRate, convolutionPartitionSize);
+    multiResolution.prepare(sampleRate);
 }
 
-SpectralProcessor::~SpectralProcessor() = default;
+SpectralProcessor::~SpectralProcessor()
+{
+    stopWorker();
+    delete maskField;
+    delete modulator;
+}
 
 void SpectralProcessor::prepareToPlay(double newSampleRate, int samplesPerBlock)
 {
+    const bool rateChanged = newSampleRate != sampleRate;
     sampleRate = newSampleRate;
     juce::ignoreUnused(samplesPerBlock);
     
-    // Reset phase accumulators
-    std::fill(prevPhase.begin(), prevPhase.end(), 0.0f);
-    std::fill(phaseAccum.begin(), phaseAccum.end(), 0.0f);
+    // Audio is stopped: the worker can be parked while the frame state is reset
+    stopWorker();
+    
+    // Resets the overlap-add state and phase accumulators
+    applyFrameConfig(requestedOrder.load(), requestedOverlap.load());
+    spectrumTap.prepare(sampleRate);
+    
+    if (backgroundRequested.load())
+        startWorker();
+    
+    convolver.prepare(sampleRate, convolutionPartitionSize);
+    multiResolution.prepare(sampleRate);
+    additiveBank.prepare(sampleRate);
+    formantEnvelope.prepare(sampleRate, maxBins);
+    
+    // Non-linear row mappings are laid out in Hz; modulator frames are analysed at the processing rate
+    if (rateChanged)
+    {
+        publishMaskField();
+        publishModulator();
+    }
 }
 
 void SpectralProcessor::releaseResources()
 {
-    // Nothing specific to release
+    stopWorker();
+}
+
+void SpectralProcessor::setBackgroundProcessing(bool enabled)
+{
+    backgroundRequested.store(enabled);
+}
+
+void SpectralProcessor::startWorker()
+{
+    workerStop.store(false);
+    worker = std::thread([this] { workerLoop(); });
+    backgroundActive = true;
+}
+
+void SpectralProcessor::stopWorker()
+{
+    if (worker.joinable())
+    {
+        {
+            const std::lock_guard<std::mutex> guard(workerLock);
+            workerStop.store(true);
+        }
+        workerWake.notify_one();
+        worker.join();
+    }
+    
+    frameRequests.clear();
+    frameResults.clear();
+    jobInFlight = false;
+    jobLate = false;
+    backgroundActive = false;
+}
+
+void SpectralProcessor::workerLoop()
+{
+    for (;;)
+    {
+        int job = 0;
+        if (frameRequests.pop(job))
+        {
+            processFrame(jobInput.data(), jobFrame.data(), jobSideFrame.data());
+            frameResults.push(job);
+            continue;
+        }
+        
+        // The audio thread only try-locks before notifying, so a wake-up can still
+        // land between the check and the wait; the timeout bounds the cost of that
+        std::unique_lock<std::mutex> guard(workerLock);
+        if (workerStop.load())
+            return;
+        workerWake.wait_for(guard, std::chrono::milliseconds(1), [this] {
+            return workerStop.load() || !frameRequests.empty();
+        });
+    }
+}
+
+void SpectralProcessor::setFrameSize(int numSamples)
+{
+    int order = minFrameOrder;
+    while (order < maxFrameOrder && (1 << order) < numSamples)
+        ++order;
+    if (order != requestedOrder.exchange(order))
+        publishModulator();
+}
+
+void SpectralProcessor::setOverlap(int framesPerWindow)
+{
+    int factor = 2;
+    while (factor < 16 && factor < framesPerWindow)
+        factor *= 2;
+    if (factor != requestedOverlap.exchange(factor))
+        publishModulator();
+}
+
+int SpectralProcessor::getLatencySamples() const
+{
+    switch (currentMode.load())
+    {
+        case Mode::Bypass:      return 0;
+        case Mode::Convolution: return convolver.getLatencySamples();
+        case Mode::LowLatencyMask: return multiResolution.getLatencySamples();
+        case Mode::Additive:    return 0;
+        default:                break;
+    }
+    
+    // One full frame, plus the hop a background frame spends on the worker
+    return activeFrameSize.load() + (backgroundActive ? activeHopSize.load() : 0);
+}
+
+void SpectralProcessor::applyFrameConfig(int order, int framesPerWindow)
+{
+    const int index = order - minFrameOrder;
+    fft = fftPlans[(size_t)index].get();
+    fftOrder = order;
+    fftSize = fft->getSize();
+    overlap = framesPerWindow;
+    hopSize = fftSize / overlap;
+    numBins = fft->getNumBins();
+    olaGain = (float)hopSize / windowSums[(size_t)index];
+    binToAmplitude = 2.0f / windowSums[(size_t)index];
+    activeFrameSize.store(fftSize);
+    activeHopSize.store(hopSize);
+    
+    // No allocation: everything is sized for maxFFTSize already
+    std::fill(inputBuffer.begin(), inputBuffer.end(), 0.0f);
+    std::fill(outputBuffer.begin(), outputBuffer.end(), 0.0f);
+    std::fill(percussiveBuffer.begin(), percussiveBuffer.end(), 0.0f);
+    std::fill(prevPhase.begin(), prevPhase.end(), 0.0f);
+    std::fill(phaseAccum.begin(), phaseAccum.end(), 0.0f);
+    std::fill(blurHistory.begin(), blurHistory.end(), 0.0f);
+    pitchShiftActive = false;
+    freezeBank.reset(numBins);
+    formantEnvelope.reset();
+    
+    // Median lengths held in time and Hz: 17 hops / 17 bins at the default 2048 / 4 configuration
+    const int defaultHop = (1 << defaultFrameOrder) / defaultOverlap;
+    splitter.reset(numBins, juce::jmax(3, 17 * defaultHop / hopSize), juce::jmax(3, 17 * fftSize / (1 << defaultFrameOrder)));
+    snapMask = true;
+    maskSettled = false;
+    captureSlot = noFreezeRequest;
+    captureArmed = false;
+    inputPos = 0;
+    outputPos = 0;
 }
 
-void SpectralProcessor::process(const float* input, float* output, int numSamples)
+void SpectralProcessor::process(const float* input, float* output, int numSamples, float* percussiveOutput)
 {
-    if (currentMode == Mode::Bypass)
+    const Mode mode = currentMode.load();
+    const bool usesFrames = mode != Mode::Bypass && mode != Mode::Convolution
+                         && mode != Mode::LowLatencyMask && mode != Mode::Additive;
+    
+    if (!usesFrames && jobInFlight)
+    {
+        // Left the STFT modes with a frame still out: its result is no longer wanted
+        int job = 0;
+        if (frameResults.pop(job))
+            jobInFlight = jobLate = false;
+    }
+    
+    // Frame state only changes here with nothing in flight; otherwise at the next hop
+    if (!jobInFlight)
+    {
+        const int order = requestedOrder.load(std::memory_order_relaxed);
+        const int framesPerWindow = requestedOverlap.load(std::memory_order_relaxed);
+        if (order != fftOrder || framesPerWindow != overlap)
+            applyFrameConfig(order, framesPerWindow);
+        
+        // Picked up in every mode so the handoff queues never fill with stale objects
+        receiveHandoffs();
+    }
+    
+    // Only the STFT path below has a second output
+    if (percussiveOutput != nullptr && !usesFrames)
+        juce::FloatVectorOperations::clear(percussiveOutput, numSamples);
+    
+    if (mode == Mode::Bypass)
     {
         std::copy(input, input + numSamples, output);
         return;
     }
     
-    for (int i = 0; i < numSamples; ++i)
+    if (mode == Mode::Convolution)
     {
-        // Input buffer (circular)
-        inputBuffer[inputPos] = input[i];
+        convolver.process(input, output, numSamples);
+        return;
+    }
+    
+    // A background frame still out owns the scan, the field and the mask: the scan
+    // waits for it, then catches up on the time that passed. Until then the
+    // low-latency path runs unmasked rather than read a mask being written.
+    if (mode == Mode::LowLatencyMask)
+    {
+        if (jobInFlight)
+        {
+            deferredScanSamples += numSamples;
+        }
+        else
+        {
+            updateMask(deferredScanSamples + numSamples);
+            deferredScanSamples = 0;
+        }
+        multiResolution.process(input, output, numSamples, jobInFlight ? nullptr : spectralMask.data(), numBins);
+        return;
+    }
+    
+    if (mode == Mode::Additive)
+    {
+        if (jobInFlight)
+        {
+            deferredScanSamples += numSamples;
+        }
+        else
+        {
+            advanceScan(deferredScanSamples + numSamples);
+            deferredScanSamples = 0;
+        }
+        const bool haveField = maskField != nullptr && !jobInFlight;
+        additiveBank.setFrequencyRange(additiveLowHz.load(std::memory_order_relaxed),
+                                       additiveHighHz.load(std::memory_order_relaxed));
+        additiveBank.render(haveField ? maskField->blendColumn(scanPosition) : nullptr,
+                            haveField ? maskField->getHeight() : 0,
+                            output, numSamples);
+        return;
+    }
+    
+    // Runs of samples up to the next hop. Both rings advance together and a hop
+    // divides the frame, so a run never wraps and each step is a straight copy.
+    using FVO = juce::FloatVectorOperations;
+    
+    for (int done = 0; done < numSamples;)
+    {
+        const int n = juce::jmin(numSamples - done, hopSize - inputPos);
+        
+        // Input is written twice so the frame history is one contiguous span
+        FVO::copy(inputBuffer.data() + outputPos, input + done, n);
+        FVO::copy(inputBuffer.data() + outputPos + fftSize, input + done, n);
         
         // Output from overlap-add buffer
-        output[i] = outputBuffer[outputPos];
-        outputBuffer[outputPos] = 0.0f;
+        FVO::copy(output + done, outputBuffer.data() + outputPos, n);
+        FVO::clear(outputBuffer.data() + outputPos, n);
+        if (percussiveOutput != nullptr)
+            FVO::copy(percussiveOutput + done, percussiveBuffer.data() + outputPos, n);
+        FVO::clear(percussiveBuffer.data() + outputPos, n);
         
-        inputPos++;
-        outputPos = (outputPos + 1) % fftSize;
+        done += n;
+        inputPos += n;
+        outputPos += n;
+        if (outputPos == fftSize)
+            outputPos = 0;
         
         // Process frame when we have enough samples
-        if (inputPos >= hopSize)
+        if (inputPos == hopSize)
         {
-            processFrame();
             inputPos = 0;
+            runHop();
         }
     }
 }
 
-void SpectralProcessor::processFrame()
+void SpectralProcessor::receiveHandoffs()
 {
-    // 1) Copy and window
-    std::copy(inputBuffer.begin(), inputBuffer.end(), inputBuffer.begin()); // redundant but keeps your pattern
-    fft->applyWindow(inputBuffer.data(), fftSize);                          // :contentReference[oaicite:2]{index=2}
+    if (auto* incoming = maskHandoff.receive())
+    {
+        maskHandoff.retire(maskField);
+        maskField = incoming;
+        maskFieldChanged = true;
+    }
+    
+    if (auto* incoming = modulatorHandoff.receive())
+    {
+        modulatorHandoff.retire(modulator);
+        modulator = incoming;
+        modulatorFrame = 0;
+    }
+}
 
-    // 2) FFT: separate real/imag arrays
-    const int numBins = fft->getSize() / 2 + 1;
-    std::vector<float> real(numBins), imag(numBins);
-    fft->forward(inputBuffer.data(), real.data(), imag.data());              // forward -> real/imag
+void SpectralProcessor::beginHop()
+{
+    // Nothing is in flight: pending configuration and mask changes can land
+    const int order = requestedOrder.load(std::memory_order_relaxed);
+    const int framesPerWindow = requestedOverlap.load(std::memory_order_relaxed);
+    if (order != fftOrder || framesPerWindow != overlap)
+        applyFrameConfig(order, framesPerWindow);
+    
+    receiveHandoffs();
+    frameMode = currentMode.load();
+}
 
-    // 3) Cartesian -> Polar
-    for (int bin = 0; bin < numBins; ++bin)
+void SpectralProcessor::runHop()
+{
+    if (!backgroundActive)
     {
-        float re = real[bin], im = imag[bin];
-        magnitude[bin] = std::sqrt(re * re + im * im);
-        phase[bin]     = std::atan2(im, re);
+        beginHop();
+        processFrame(inputBuffer.data() + outputPos, fftFrame.data(), sideFrame.data());
+        overlapAdd(fftFrame.data(), frameMode == Mode::HarmonicPercussive ? sideFrame.data() : nullptr);
     }
+    else
+    {
+        // The frame sent last hop is due now. The audio thread never waits for the
+        // worker: if it overran, this hop goes out without that frame and no new one
+        // is sent until the worker is free. A result that arrives late lines up with
+        // an earlier hop, so it is discarded.
+        if (jobInFlight)
+        {
+            int job = 0;
+            if (!frameResults.pop(job))
+            {
+                if (!jobLate)
+                    backgroundOverruns.fetch_add(1, std::memory_order_relaxed);
+                jobLate = true;
+                return;
+            }
+            
+            if (!jobLate)
+                overlapAdd(jobFrame.data(), frameMode == Mode::HarmonicPercussive ? jobSideFrame.data() : nullptr);
+            jobInFlight = jobLate = false;
+        }
+        
+        beginHop();
+        juce::FloatVectorOperations::copy(jobInput.data(), inputBuffer.data() + outputPos, fftSize);
+        if (frameRequests.push(0))
+        {
+            jobInFlight = true;
+            
+            // Never waits. Holding the lock for a moment orders the push before the
+            // worker's next check; if the worker holds it right now, its wait timeout
+            // covers a wake-up that slips between its check and its wait.
+            if (workerLock.try_lock())
+                workerLock.unlock();
+            workerWake.notify_one();
+        }
+    }
+}
 
-    // 4) Spectral processing
-    switch (currentMode)
+void SpectralProcessor::processFrame(const float* history, float* frame, float* side)
+{
+    PackedSpectrum spectrum { frame, numBins };
+    
+    // A fully recalled freeze resynthesises from stored frames: no analysis needed
+    if (frameMode == Mode::SpectralFreeze)
+        pollFreezeRequests();
+    
+    // A fully closed mask passes nothing: skip both transforms
+    if (frameMode == Mode::FrequencyMask)
+    {
+        updateMask(hopSize);
+        if (numMaskRuns == 0)
+        {
+            juce::FloatVectorOperations::clear(frame, 2 * numBins); // covers the packed bins, so displays show silence
+            spectrumTap.push(spectrum, binToAmplitude, hopSize);
+            return;
+        }
+    }
+    
+    const bool analyse = frameMode != Mode::SpectralFreeze
+                      || freezeBank.needsLiveInput()
+                      || captureSlot != noFreezeRequest;
+    
+    if (analyse)
     {
-        case Mode::FrequencyMask: applyFrequencyMask();     break;
-        case Mode::SpectralBlur:  applySpectralBlur();      break;
-        case Mode::SpectralFreeze:applySpectralFreeze();    break;
-        case Mode::PitchShift:    applyPitchShift();        break;
-        case Mode::FormantShift:  applyFormantShift();      break;
-        default:                                           break;
+        // 1) Window the input history straight into the FFT frame (history stays intact)
+        fft->applyWindow(history, frame, fftSize);
+        
+        // 2) FFT in place; every stage below reads/writes the packed bins directly
+        spectrum = fft->forwardInPlace(frame);
     }
 
-    // 5) Polar -> Cartesian
-    for (int bin = 0; bin < numBins; ++bin)
+    // 3) Spectral processing. A mask only scales magnitudes, so it is applied to
+    //    the packed bins and skips the polar round trip entirely; so do freeze,
+    //    cross-synthesis and formant shifting.
+    if (frameMode == Mode::FrequencyMask)
+    {
+        applyFrequencyMask(spectrum);
+    }
+    else if (frameMode == Mode::SpectralFreeze)
     {
-        real[bin] = magnitude[bin] * std::cos(phase[bin]);
-        imag[bin] = magnitude[bin] * std::sin(phase[bin]);
+        applySpectralFreeze(spectrum);
     }
+    else if (frameMode == Mode::CrossSynthesis)
+    {
+        applyCrossSynthesis(spectrum);
+    }
+    else if (frameMode == Mode::FormantShift)
+    {
+        applyFormantShift(spectrum);
+    }
+    else if (frameMode == Mode::HarmonicPercussive)
+    {
+        updateMask(hopSize);
+        applyHarmonicPercussive(spectrum, side);
+        fft->inverseInPlace(side);
+    }
+    else
+    {
+        // Cartesian -> Polar
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const float re = spectrum.re(bin), im = spectrum.im(bin);
+            magnitude[bin] = std::sqrt(re * re + im * im);
+            phase[bin]     = std::atan2(im, re);
+        }
 
-    // 6) Inverse FFT
-    fft->inverse(real.data(), imag.data(), fftData.data());                 // inverse -> time-domain buffer
+        switch (frameMode)
+        {
+            case Mode::SpectralBlur:  applySpectralBlur();      break;
+            case Mode::PitchShift:    applyPitchShift();        break;
+            default:                                           break;
+        }
 
-    // 7) Overlap-add back into circular buffer
-    const float scaleFactor = 1.0f / (fftSize * 0.5f); // compensate for FFT scaling & overlap
-    for (int n = 0; n < fftSize; ++n)
-    {
-        int outIdx = (outputPos + n) % fftSize;
-        outputBuffer[outIdx] += fftData[n] * scaleFactor;
+        // Polar -> Cartesian
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            spectrum.re(bin) = magnitude[bin] * std::cos(phase[bin]);
+            spectrum.im(bin) = magnitude[bin] * std::sin(phase[bin]);
+        }
     }
 
-    // 8) Rotate input buffer
-    std::rotate(inputBuffer.begin(), inputBuffer.begin() + hopSize, inputBuffer.end());
+    // 4) Displays see the processed spectrum (a no-op unless a reader is attached)
+    spectrumTap.push(spectrum, binToAmplitude, hopSize);
+    
+    // 5) Inverse FFT in place -> frame[0..fftSize) is the time-domain output
+    fft->inverseInPlace(frame);
+}
+
+void SpectralProcessor::overlapAdd(const float* frame, const float* side)
+{
+    // Overlap-add back into the ring: the frame spans it exactly once, in two runs
+    const int first = fftSize - outputPos;
+    juce::FloatVectorOperations::addWithMultiply(outputBuffer.data() + outputPos, frame, olaGain, first);
+    juce::FloatVectorOperations::addWithMultiply(outputBuffer.data(), frame + first, olaGain, outputPos);
+    
+    if (side != nullptr)
+    {
+        juce::FloatVectorOperations::addWithMultiply(percussiveBuffer.data() + outputPos, side, olaGain, first);
+        juce::FloatVectorOperations::addWithMultiply(percussiveBuffer.data(), side + first, olaGain, outputPos);
+    }
 }
 
 // (The rest of your methods stay exactly as before:)
 
-void SpectralProcessor::applyFrequencyMask()
+void SpectralProcessor::advanceScan(int elapsedSamples)
 {
-    int bins = (int)magnitude.size();
-    for (int i = 0; i < bins; ++i)
-        magnitude[i] *= spectralMask[i];
+    // A new position from the UI wins; otherwise the scan runs on at scanRate
+    const float request = requestedScanPosition.load(std::memory_order_relaxed);
+    if (request != lastScanRequest)
+    {
+        lastScanRequest = request;
+        scanPosition = request;
+    }
+    else if (const float rate = scanRate.load(std::memory_order_relaxed); rate != 0.0f)
+    {
+        scanPosition += rate * (float)elapsedSamples / (float)sampleRate;
+        scanPosition -= std::floor(scanPosition);
+    }
 }
 
-void SpectralProcessor::applySpectralBlur()
+void SpectralProcessor::updateMask(int elapsedSamples)
 {
-    if (blurAmount <= 0.0f) return;
-    int bins = (int)magnitude.size();
-    int radius = static_cast<int>(blurAmount * 10.0f);
-    std::vector<float> blurred(bins);
+    advanceScan(elapsedSamples);
+    
+    // The column only needs rendering again when the scan or the field moved
+    if (maskField != nullptr && (maskFieldChanged || snapMask || scanPosition != renderedScan))
+    {
+        maskField->renderColumn(scanPosition, targetMask.data(), numBins);
+        renderedScan = scanPosition;
+        maskFieldChanged = false;
+        maskSettled = false;
+    }
+    
+    if (maskSettled && !snapMask)
+        return;
+    
+    // One-pole glide per bin, so masks published at the UI rate do not step
+    const float slewSamples = maskSlewMs.load(std::memory_order_relaxed) * 0.001f * (float)sampleRate;
+    const float amount = (snapMask || slewSamples <= 0.0f)
+                       ? 1.0f
+                       : 1.0f - std::exp(-(float)elapsedSamples / slewSamples);
+    snapMask = false;
+    
+    juce::FloatVectorOperations::subtract(maskDelta.data(), targetMask.data(), spectralMask.data(), numBins);
+    const auto range = juce::FloatVectorOperations::findMinAndMax(maskDelta.data(), numBins);
+    if (juce::jmax(-range.getStart(), range.getEnd()) * (1.0f - amount) < 1.0e-5f)
+    {
+        // Close enough to land: further hops cost nothing until the target moves
+        juce::FloatVectorOperations::copy(spectralMask.data(), targetMask.data(), numBins);
+        maskSettled = true;
+    }
+    else
+    {
+        juce::FloatVectorOperations::addWithMultiply(spectralMask.data(), maskDelta.data(), amount, numBins);
+    }
+    
+    rebuildMaskRuns();
+}
+
+void SpectralProcessor::rebuildMaskRuns()
+{
+    // A bin is closed once both its target and its gain are under -80 dB; the
+    // target decides, so a bin opening from zero joins a run on the first hop.
+    // Gains are left as they are, so the glide still lands on the target.
+    constexpr float closedGain = 1.0e-4f;
+    const auto isOpen = [this](int bin)
+    {
+        return targetMask[(size_t)bin] > closedGain || spectralMask[(size_t)bin] > closedGain;
+    };
+    
+    numMaskRuns = 0;
+    int bin = 0;
+    while (bin < numBins)
+    {
+        while (bin < numBins && !isOpen(bin))
+            ++bin;
+        if (bin == numBins)
+            break;
+        
+        maskRunStart[(size_t)numMaskRuns] = bin;
+        while (bin < numBins && isOpen(bin))
+            ++bin;
+        maskRunEnd[(size_t)numMaskRuns++] = bin;
+    }
+}
 
-    for (int i = 0; i < bins; ++i)
+void SpectralProcessor::applyFrequencyMask(const PackedSpectrum& spectrum)
+{
+    // Scaling re and im by the same gain scales the magnitude and keeps the phase.
+    // Only the open runs are scaled; the closed bins between them are cleared.
+    int gapStart = 0;
+    for (int run = 0; run < numMaskRuns; ++run)
     {
-        float sum = 0.0f, wsum = 0.0f;
-        for (int j = -radius; j <= radius; ++j)
+        const int start = maskRunStart[(size_t)run], end = maskRunEnd[(size_t)run];
+        juce::FloatVectorOperations::clear(spectrum.data + 2 * gapStart, 2 * (start - gapStart));
+        for (int i = start; i < end; ++i)
         {
-            int idx = i + j;
-            if (idx >= 0 && idx < bins)
-            {
-                float w = 1.0f / (1.0f + std::abs(j));
-                sum += magnitude[idx] * w;
-                wsum += w;
-            }
+            const float gain = spectralMask[(size_t)i];
+            spectrum.re(i) *= gain;
+            spectrum.im(i) *= gain;
         }
-        blurred[i] = sum / wsum;
+        gapStart = end;
     }
+    juce::FloatVectorOperations::clear(spectrum.data + 2 * gapStart, 2 * (spectrum.numBins - gapStart));
+}
 
-    for (int i = 0; i < bins; ++i)
-        magnitude[i] = magnitude[i] * (1.0f - blurAmount) + blurred[i] * blurAmount;
+namespace
+{
+    // Centred moving average of half-width h, edges averaged over the taps that
+    // exist, blended into dst: dst = lerp(dst, average, mix). One add and one
+    // subtract per bin whatever the width. src and dst must not overlap.
+    void boxBlur(const float* src, float* dst, int n, int h, float mix) noexcept
+    {
+        const float invFull = 1.0f / (float)(2 * h + 1);
+        double sum = 0.0;
+        for (int j = 0; j <= juce::jmin(h, n - 1); ++j)
+            sum += src[j];
+
+        for (int i = 0; i < n; ++i)
+        {
+            const int lo = i - h, hi = i + h;
+            const float average = (lo >= 0 && hi < n) ? (float)sum * invFull
+                                                      : (float)(sum / (juce::jmin(hi, n - 1) - juce::jmax(lo, 0) + 1));
+            dst[i] += mix * (average - dst[i]);
+            if (hi + 1 < n) sum += src[hi + 1];
+            if (lo >= 0)    sum -= src[lo];
+        }
+    }
 }
 
-void SpectralProcessor::applySpectralFreeze()
+void SpectralProcessor::applySpectralBlur()
 {
-    int bins = (int)phase.size();
-    if (!freezeEnabled)
+    const int bins = numBins;
+    float* mag = magnitude.data();
+
+    // Temporal: one-pole smoothing of each bin across frames; time constant is
+    // independent of hop size
+    if (temporalBlurSeconds > 0.0f)
     {
-        prevPhase = phase;
-        return;
+        const float keep = (float)std::exp(-hopSize / (temporalBlurSeconds * sampleRate));
+        float* history = blurHistory.data();
+        juce::FloatVectorOperations::multiply(history, keep, bins);
+        juce::FloatVectorOperations::addWithMultiply(history, mag, 1.0f - keep, bins);
+        juce::FloatVectorOperations::copy(mag, history, bins);
     }
-    for (int i = 0; i < bins; ++i)
+
+    if (blurAmount <= 0.0f) return;
+
+    // Spectral: two box passes make a triangular kernel reaching 2 * halfWidth bins.
+    // The radius is in bins of the default 2048 frame, scaled so the blur covers the
+    // same bandwidth at any size; rounding up keeps any non-zero amount blurring.
+    const float radius = blurAmount * 10.0f * (float)fftSize / (float)(1 << defaultFrameOrder);
+    const int halfWidth = juce::jmax(1, (int)std::ceil(radius * 0.5f));
+
+    float* blurred = blurScratch.data();
+    boxBlur(mag, blurred, bins, halfWidth, 1.0f);
+    boxBlur(blurred, mag, bins, halfWidth, blurAmount);
+}
+
+void SpectralProcessor::pollFreezeRequests()
+{
+    // Recall first: setFreezeEnabled stores capture before recall, so a recall seen
+    // here always comes with its capture
+    const int recall = pendingRecall.exchange(noFreezeRequest);
+    const int capture = pendingCapture.exchange(noFreezeRequest);
+    
+    if (capture != noFreezeRequest)
     {
-        phaseAccum[i] += 0.01f;
-        phase[i] = phaseAccum[i];
+        captureSlot = capture;
+        captureArmed = false;
     }
+    if (recall != noFreezeRequest)
+        deferredRecall = recall;
 }
 
-void SpectralProcessor::applyPitchShift()
+void SpectralProcessor::applySpectralFreeze(const PackedSpectrum& spectrum)
 {
-    if (pitchShiftFactor == 1.0f) return;
-    int bins = (int)magnitude.size();
-    std::vector<float> mag2(bins), phs2(bins);
+    // A capture spans two live frames: their phase difference gives each bin's
+    // true frequency
+    if (captureSlot != noFreezeRequest)
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const float re = spectrum.re(bin), im = spectrum.im(bin);
+            magnitude[bin] = std::sqrt(re * re + im * im);
+            phase[bin]     = std::atan2(im, re);
+        }
+        
+        if (captureArmed)
+        {
+            const float binAdvance = 2.0f * juce::MathConstants<float>::pi * (float)hopSize / (float)fftSize;
+            freezeBank.capture(captureSlot, magnitude.data(), phase.data(), prevPhase.data(), numBins, binAdvance);
+            captureSlot = noFreezeRequest;
+            captureArmed = false;
+        }
+        else
+        {
+            captureArmed = true;
+        }
+        std::copy(phase.begin(), phase.begin() + numBins, prevPhase.begin());
+    }
+    
+    if (captureSlot == noFreezeRequest && deferredRecall != noFreezeRequest)
+    {
+        const float fadeSamples = freezeFadeMs.load() * 0.001f * (float)sampleRate;
+        freezeBank.recall(deferredRecall, juce::roundToInt(fadeSamples / (float)hopSize));
+        deferredRecall = noFreezeRequest;
+    }
+    
+    freezeBank.render(spectrum);
+}
 
-    for (int i = 1; i < bins - 1; ++i)
+void SpectralProcessor::applyPitchShift()
+{
+    const int bins = numBins;
+    float* mag = magnitude.data();
+    float* phs = phase.data();
+    
+    if (pitchShiftFactor == 1.0f || !pitchShiftActive)
+    {
+        // Unshifted (or first shifted) frame: output phase = analysis phase, so
+        // tracking starts from a consistent state
+        juce::FloatVectorOperations::copy(phaseAccum.data(), phs, bins);
+        juce::FloatVectorOperations::copy(prevPhase.data(), phs, bins);
+        pitchShiftActive = pitchShiftFactor != 1.0f;
+        return;
+    }
+    
+    // Identity phase locking (Laroche & Dolson): find spectral peaks, advance
+    // each peak's phase at its measured frequency, and move the whole region of
+    // bins around it by the same whole-bin offset and phase rotation.
+    const float factor = pitchShiftFactor;
+    const float binAdvance = 2.0f * juce::MathConstants<float>::pi * (float)hopSize / (float)fftSize;
+    const float threshold = 1.0e-4f * juce::FloatVectorOperations::findMaximum(mag, bins);
+    
+    int numPeaks = 0;
+    for (int k = 2; k < bins - 2; ++k)
+    {
+        const float m = mag[k];
+        if (m > threshold && m > mag[k - 1] && m >= mag[k + 1] && m > mag[k - 2] && m >= mag[k + 2])
+            peakBins[(size_t)numPeaks++] = k;
+    }
+    
+    float* outMag = shiftedMagnitude.data();
+    float* outPhase = shiftedPhase.data();
+    juce::FloatVectorOperations::clear(outMag, bins);
+    juce::FloatVectorOperations::copy(outPhase, phaseAccum.data(), bins);
+    
+    int regionStart = 0;
+    int writeEnd = 0;  // regions never overwrite bins an earlier (lower) region produced
+    for (int p = 0; p < numPeaks; ++p)
     {
-        float shifted = i * pitchShiftFactor;
-        int lo = int(shifted), hi = lo + 1;
-        float frac = shifted - lo;
-        if (hi < bins)
+        const int k = peakBins[(size_t)p];
+        const int regionEnd = (p + 1 < numPeaks) ? (k + peakBins[(size_t)(p + 1)] + 1) / 2 : bins;
+        const int target = juce::roundToInt((float)k * factor);
+        if (target >= bins)
+            break;
+        
+        // Measured frequency of the peak, in bins
+        const float deviation = princArg(phs[k] - prevPhase[(size_t)k] - binAdvance * (float)k);
+        const float trueBin = (float)k + deviation / binAdvance;
+        
+        const float peakPhase = princArg(phaseAccum[(size_t)target] + binAdvance * trueBin * factor);
+        const float rotation = peakPhase - phs[k];
+        
+        const int offset = target - k;
+        const int dstStart = juce::jmax(regionStart + offset, writeEnd);
+        const int dstEnd = juce::jmin(regionEnd + offset, bins);
+        if (dstEnd > dstStart)
         {
-            mag2[i] = magnitude[lo] * (1 - frac) + magnitude[hi] * frac;
-            float dp = phase[lo] - prevPhase[lo];
-            dp = princArg(dp);
-            float trueFreq = (2 * juce::MathConstants<float>::pi * hopSize * lo) / fftSize
-                            + dp * fftSize / (2 * juce::MathConstants<float>::pi * hopSize);
-            phaseAccum[i] += (2 * juce::MathConstants<float>::pi * hopSize * trueFreq) / fftSize;
-            phs2[i] = phaseAccum[i];
+            juce::FloatVectorOperations::copy(outMag + dstStart, mag + dstStart - offset, dstEnd - dstStart);
+            juce::FloatVectorOperations::add(outPhase + dstStart, phs + dstStart - offset, rotation, dstEnd - dstStart);
+            writeEnd = dstEnd;
         }
+        regionStart = regionEnd;
     }
-    magnitude = mag2;
-    phase     = phs2;
+    
+    juce::FloatVectorOperations::copy(prevPhase.data(), phs, bins);
+    juce::FloatVectorOperations::copy(phaseAccum.data(), outPhase, bins);
+    juce::FloatVectorOperations::copy(mag, outMag, bins);
+    juce::FloatVectorOperations::copy(phs, outPhase, bins);
 }
 
-void SpectralProcessor::applyFormantShift()
+void SpectralProcessor::applyFormantShift(const PackedSpectrum& spectrum)
 {
     if (formantShiftAmount == 0.0f) return;
-    int bins = (int)magnitude.size();
-    std::vector<float> warped(bins);
-    float warp = std::pow(2.0f, formantShiftAmount / 12.0f);
-    for (int i = 0; i < bins; ++i)
+    
+    for (int i = 0; i < numBins; ++i)
+        magnitude[i] = std::sqrt(spectrum.re(i) * spectrum.re(i) + spectrum.im(i) * spectrum.im(i));
+    
+    // Only the envelope moves: gain = warped envelope / envelope, so the
+    // harmonics stay put. Rebuilt only when the envelope or the shift changed.
+    const bool envelopeChanged = formantEnvelope.update(magnitude.data(), numBins);
+    if (envelopeChanged || formantShiftAmount != formantGainShift)
     {
-        float src = i / warp;
-        int lo = int(src), hi = lo + 1;
-        float frac = src - lo;
-        warped[i] = (hi < bins)
-                   ? magnitude[lo] * (1-frac) + magnitude[hi] * frac
-                   : 0.0f;
+        const float* logEnvelope = formantEnvelope.getLogEnvelope();
+        const float warp = std::pow(2.0f, formantShiftAmount / 12.0f);
+        const float maxLogGain = 2.77f; // +24 dB, so a formant moved onto a near-empty region stays sane
+        
+        for (int i = 0; i < numBins; ++i)
+        {
+            const float src = juce::jmin(i / warp, (float)(numBins - 1));
+            const int lo = juce::jmin(int(src), numBins - 2);
+            const float frac = src - lo;
+            const float warped = logEnvelope[lo] * (1 - frac) + logEnvelope[lo + 1] * frac;
+            formantGain[i] = std::exp(juce::jmin(warped - logEnvelope[i], maxLogGain));
+        }
+        formantGainShift = formantShiftAmount;
+    }
+    
+    for (int i = 0; i < numBins; ++i)
+    {
+        spectrum.re(i) *= formantGain[i];
+        spectrum.im(i) *= formantGain[i];
     }
-    magnitude = warped;
 }
 
 void SpectralProcessor::setSpectralMask(const std::vector<float>& mask)
 {
-    size_t bins = spectralMask.size(), msz = mask.size();
-    if (msz == 0) return;
-    for (size_t i = 0; i < bins; ++i)
+    // A 1-D curve is a field one column wide
+    maskSource = mask;
+    maskSourceWidth = 0;
+    maskSourceHeight = (int)mask.size();
+    publishMaskField();
+}
+
+void SpectralProcessor::publishMaskField()
+{
+    if (maskSource.empty())
+        return;
+    
+    const SpectralMaskField::Mapping mapping { frequencyScale, sampleRate, maxBins, (1 << minFrameOrder) / 2 + 1 };
+    auto field = maskSourceWidth == 0
+        ? SpectralMaskField::fromCurve(maskSource.data(), maskSourceHeight, mapping)
+        : SpectralMaskField::fromImage(maskSource.data(), maskSourceWidth, maskSourceHeight, mapping);
+    
+    if (field != nullptr)
+        maskHandoff.publish(std::move(field));
+}
+
+bool SpectralProcessor::setCrossSynthesisModulator(const juce::AudioBuffer<float>& source, double sourceSampleRate)
+{
+    const int numChannels = source.getNumChannels();
+    const int numSamples = source.getNumSamples();
+    if (numChannels == 0 || numSamples == 0 || sourceSampleRate <= 0.0)
+        return false;
+    
+    // Mono mix-down, kept so the frames can be rebuilt for another configuration
+    modulatorSource.assign((size_t)numSamples, 0.0f);
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::addWithMultiply(modulatorSource.data(), source.getReadPointer(channel),
+                                                     1.0f / (float)numChannels, numSamples);
+    modulatorSourceRate = sourceSampleRate;
+    
+    publishModulator();
+    return true;
+}
+
+void SpectralProcessor::publishModulator()
+{
+    if (modulatorSource.empty())
+        return;
+    
+    const int order = requestedOrder.load();
+    const int hop = (1 << order) / requestedOverlap.load();
+    auto analysis = CrossSynthesisModulator::analyse(modulatorSource.data(), (int)modulatorSource.size(),
+                                                     modulatorSourceRate, sampleRate, order, hop);
+    if (analysis != nullptr)
+        modulatorHandoff.publish(std::move(analysis));
+}
+
+void SpectralProcessor::setCrossSynthesisAmount(float amount)
+{
+    crossSynthesisAmount.store(juce::jlimit(0.0f, 1.0f, amount));
+}
+
+void SpectralProcessor::applyCrossSynthesis(const PackedSpectrum& spectrum)
+{
+    // Frames analysed for another configuration are ignored until the new ones arrive
+    if (modulator == nullptr || modulator->getNumBins() != numBins || modulator->getHopSize() != hopSize)
+        return;
+    
+    const float* envelope = modulator->getFrame(modulatorFrame);
+    if (++modulatorFrame >= modulator->getNumFrames())
+        modulatorFrame = 0;
+    
+    // Input phase, magnitude moved towards the modulator's: at amount 1 each bin
+    // is rescaled to the modulator magnitude (never above it, even for a silent bin)
+    const float amount = crossSynthesisAmount.load(std::memory_order_relaxed);
+    for (int i = 0; i < spectrum.numBins; ++i)
+    {
+        const float re = spectrum.re(i), im = spectrum.im(i);
+        const float norm = std::sqrt(re * re + im * im);
+        const float gain = 1.0f + amount * (envelope[i] / (norm + 1.0e-9f) - 1.0f);
+        spectrum.re(i) = re * gain;
+        spectrum.im(i) = im * gain;
+    }
+}
+
+void SpectralProcessor::applyHarmonicPercussive(const PackedSpectrum& spectrum, float* side)
+{
+    for (int i = 0; i < numBins; ++i)
+        magnitude[i] = std::sqrt(spectrum.re(i) * spectrum.re(i) + spectrum.im(i) * spectrum.im(i));
+    
+    splitter.process(magnitude.data(), harmonicGain.data());
+    
+    // Percussive share to the side frame; the harmonic share also takes the mask
+    PackedSpectrum percussive { side, numBins };
+    for (int i = 0; i < numBins; ++i)
     {
-        float pos = i * float(msz - 1) / float(bins - 1);
-        int idx = int(pos);
-        float f = pos - idx;
-        spectralMask[i] = (idx + 1 < msz)
-                        ? mask[idx] * (1-f) + mask[idx+1] * f
-                        : mask[idx];
+        const float harmonic = harmonicGain[i];
+        percussive.re(i) = spectrum.re(i) * (1.0f - harmonic);
+        percussive.im(i) = spectrum.im(i) * (1.0f - harmonic);
+        spectrum.re(i) *= harmonic * spectralMask[(size_t)i];
+        spectrum.im(i) *= harmonic * spectralMask[(size_t)i];
     }
 }
 
@@ -237,9 +933,33 @@ void SpectralProcessor::setBlurAmount(float amount)
     blurAmount = juce::jlimit(0.0f, 1.0f, amount);
 }
 
+void SpectralProcessor::setTemporalBlur(float amount)
+{
+    temporalBlurSeconds = 2.0f * juce::jlimit(0.0f, 1.0f, amount);
+}
+
 void SpectralProcessor::setFreezeEnabled(bool enabled)
 {
-    freezeEnabled = enabled;
+    if (enabled)
+        pendingCapture.store(momentaryFreezeSlot);
+    pendingRecall.store(enabled ? momentaryFreezeSlot : SpectralFreezeBank::live);
+}
+
+void SpectralProcessor::captureFreezeSlot(int slot)
+{
+    if (slot >= 0 && slot < numFreezeSlots)
+        pendingCapture.store(slot);
+}
+
+void SpectralProcessor::recallFreezeSlot(int slot)
+{
+    if (slot == SpectralFreezeBank::live || (slot >= 0 && slot < numFreezeSlots))
+        pendingRecall.store(slot);
+}
+
+void SpectralProcessor::setFreezeFadeTime(float milliseconds)
+{
+    freezeFadeMs.store(juce::jlimit(0.0f, 5000.0f, milliseconds));
 }
 
 void SpectralProcessor::setPitchShift(float semitones)
@@ -252,10 +972,55 @@ void SpectralProcessor::setFormantShift(float amount)
     formantShiftAmount = juce::jlimit(-12.0f, 12.0f, amount);
 }
 
+bool SpectralProcessor::setConvolutionImpulse(const juce::AudioBuffer<float>& impulse, double impulseSampleRate)
+{
+    return convolver.loadImpulse(impulse, impulseSampleRate);
+}
+
+bool SpectralProcessor::setConvolutionSpectrum(const std::vector<float>& magnitudes, int impulseLength)
+{
+    return convolver.loadImpulseFromSpectrum(magnitudes.data(), (int)magnitudes.size(), impulseLength);
+}
+
 void SpectralProcessor::applyImageMask(const std::vector<float>& imageBrightness, int width, int height)
 {
-    juce::ignoreUnused(width, height);
-    setSpectralMask(imageBrightness);
+    if (width <= 0 || height <= 0 || imageBrightness.size() < (size_t)width * (size_t)height)
+        return;
+    
+    maskSource.assign(imageBrightness.begin(), imageBrightness.begin() + (ptrdiff_t)width * height);
+    maskSourceWidth = width;
+    maskSourceHeight = height;
+    publishMaskField();
+}
+
+void SpectralProcessor::setScanPosition(float x)
+{
+    requestedScanPosition.store(juce::jlimit(0.0f, 1.0f, x));
+}
+
+void SpectralProcessor::setScanRate(float widthsPerSecond)
+{
+    scanRate.store(widthsPerSecond);
+}
+
+void SpectralProcessor::setMaskSlew(float milliseconds)
+{
+    maskSlewMs.store(juce::jlimit(0.0f, 1000.0f, milliseconds));
+}
+
+void SpectralProcessor::setAdditiveRange(float lowHz, float highHz)
+{
+    additiveLowHz.store(juce::jlimit(10.0f, 20000.0f, juce::jmin(lowHz, highHz)));
+    additiveHighHz.store(juce::jlimit(10.0f, 24000.0f, juce::jmax(lowHz, highHz)));
+}
+
+void SpectralProcessor::setFrequencyScale(SpectralMaskField::FrequencyScale scale)
+{
+    if (scale == frequencyScale)
+        return;
+    
+    frequencyScale = scale;
+    publishMaskField();
 }
 
 float SpectralProcessor::princArg(float phaseIn)
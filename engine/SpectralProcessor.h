@@ -1,7 +1,24 @@
 // source/engine/SpectralProcessor.h
 #pragma once
 #include "../core/FFTWrapper.h"
+#include "../core/AlignedBuffer.h"
+#include "PartitionedConvolver.h"
+#include "MultiResolutionSTFT.h"
+#include "SpectralFreezeBank.h"
+#include "SpectralMaskField.h"
+#include "AdditiveOscillatorBank.h"
+#include "CrossSynthesisModulator.h"
+#include "SpectralEnvelope.h"
+#include "HarmonicPercussiveSplitter.h"
+#include "SpectrumTap.h"
+#include "../core/RealtimeHandoff.h"
+#include "../core/LockFreeFIFO.h"
 #include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 class SpectralProcessor
@@ -23,67 +40,259 @@ public:
         SpectralFreeze,
         Convolution,
         PitchShift,
-        FormantShift
+        FormantShift,
+        LowLatencyMask,  // frequency mask on the multi-resolution STFT, ~2.7 ms latency at 48 kHz
+        Additive,        // image rows resynthesised as log-spaced partials; the input is not used
+        CrossSynthesis,  // input spectrum shaped by a stored modulator's magnitudes
+        HarmonicPercussive // harmonic part through the frequency mask to the output, percussive part to its own output
     };
     
-    void setMode(Mode newMode) { currentMode = newMode; }
-    Mode getMode() const { return currentMode; }
+    void setMode(Mode newMode) { currentMode.store(newMode); }
+    Mode getMode() const { return currentMode.load(); }
     
-    // Main processing
-    void process(const float* input, float* output, int numSamples);
+    // Main processing. percussiveOutput (optional) receives the percussive part
+    // in HarmonicPercussive mode, aligned with output, and silence otherwise.
+    void process(const float* input, float* output, int numSamples, float* percussiveOutput = nullptr);
     
     // Effect parameters
     void setSpectralMask(const std::vector<float>& mask);
     void setBlurAmount(float amount);
-    void setFreezeEnabled(bool enabled);
+    void setTemporalBlur(float amount);       // 0 = off .. 1 = ~2 s smear across frames
+    void setFreezeEnabled(bool enabled);      // momentary freeze, backed by the last bank slot
     void setPitchShift(float semitones);
     void setFormantShift(float amount);
     
-    // Image-based control
+    // Convolution (message thread; partitions are prepared here, not on the audio thread)
+    bool setConvolutionImpulse(const juce::AudioBuffer<float>& impulse, double impulseSampleRate);
+    bool setConvolutionSpectrum(const std::vector<float>& magnitudes, int impulseLength = 4096);
+    
+    // Cross-synthesis (message thread). The modulator is analysed here, and again
+    // whenever the frame size, overlap or sample rate changes; it loops during playback.
+    bool setCrossSynthesisModulator(const juce::AudioBuffer<float>& source, double sourceSampleRate);
+    void setCrossSynthesisAmount(float amount); // 0 = input unchanged .. 1 = modulator magnitudes
+    
+    // Freeze bank (message thread; applied in SpectralFreeze mode). A capture stores
+    // the next analysed frames in a slot; recall crossfades to a slot, or back to
+    // the input with SpectralFreezeBank::live.
+    static constexpr int numFreezeSlots = SpectralFreezeBank::numSlots - 1;
+    void captureFreezeSlot(int slot);
+    void recallFreezeSlot(int slot);
+    void setFreezeFadeTime(float milliseconds);
+    
+    // Image-based control (message thread). The image becomes a time/frequency
+    // field: columns are scanned over time, rows map to frequency (top = high).
+    // Row-major brightness, width * height values.
     void applyImageMask(const std::vector<float>& imageBrightness, int width, int height);
+    void setScanPosition(float x);            // 0..1 across the image
+    void setScanRate(float widthsPerSecond);  // 0 = hold the position; negative runs backwards
+    void setFrequencyScale(SpectralMaskField::FrequencyScale scale); // how image rows map to frequency
+    void setMaskSlew(float milliseconds);     // per-bin glide towards each new mask column, 0 = instant
+    void setAdditiveRange(float lowHz, float highHz); // bottom and top image rows in Additive mode
+    
+    // Frame size / overlap (message thread). Plans and windows for every supported
+    // size are built up front; the audio thread switches at the start of the next block.
+    static constexpr int minFrameOrder = 8;   // 256 samples
+    static constexpr int maxFrameOrder = 14;  // 16384 samples
+    void setFrameSize(int numSamples);        // rounded to the nearest supported power of two
+    void setOverlap(int framesPerWindow);     // 2, 4, 8 or 16
     
     int getFFTSize() const { return fftSize; }
+    int getHopSize() const { return hopSize; }
+    
+    // Background frame processing (message thread; takes effect at the next
+    // prepareToPlay). Each frame is handed to a worker thread and its result
+    // overlap-added one hop later, so the FFT cost is spread across blocks instead
+    // of landing on the block that contains the hop. Adds one hop of latency.
+    // The audio thread never waits: a frame the worker has not finished in time
+    // is dropped from the output and counted as an overrun.
+    void setBackgroundProcessing(bool enabled);
+    bool isBackgroundProcessing() const { return backgroundActive; }
+    int getBackgroundOverruns() const { return backgroundOverruns.load(); }
+    
+    // Latency of the current mode and the frame configuration in use (not one
+    // still pending), for AudioProcessor::setLatencySamples. Any thread.
+    int getLatencySamples() const;
+    
+    // Processed frames reduced for displays; the reader enables it while it is visible
+    SpectrumTap& getSpectrumTap() { return spectrumTap; }
     
 private:
-    static constexpr int fftOrder = 11; // 2048 samples
-    static constexpr int fftSize = 1 << fftOrder;
-    static constexpr int hopSize = fftSize / 4;
+    static constexpr int defaultFrameOrder = 11; // 2048 samples
+    static constexpr int defaultOverlap = 4;
+    static constexpr int maxFFTSize = 1 << maxFrameOrder;
+    static constexpr int maxBins = maxFFTSize / 2 + 1;
+    static constexpr int numFrameOrders = maxFrameOrder - minFrameOrder + 1;
+    static constexpr int convolutionPartitionSize = 256; // convolution latency in samples
     
-    Mode currentMode = Mode::Bypass;
+    std::atomic<Mode> currentMode { Mode::Bypass };
+    Mode frameMode = Mode::Bypass;          // mode of the frame being processed, latched each hop
     double sampleRate = 44100.0;
     
-    // FFT
-    std::unique_ptr<FFTWrapper> fft;
+    // Active frame configuration (audio thread)
+    int fftOrder = defaultFrameOrder;
+    int fftSize = 1 << defaultFrameOrder;
+    int hopSize = fftSize / defaultOverlap;
+    int numBins = fftSize / 2 + 1;
+    int overlap = defaultOverlap;
+    
+    // Active frame and hop, mirrored for getLatencySamples on other threads
+    std::atomic<int> activeFrameSize { 1 << defaultFrameOrder };
+    std::atomic<int> activeHopSize { (1 << defaultFrameOrder) / defaultOverlap };
+    
+    // Requested configuration (message thread -> audio thread)
+    std::atomic<int> requestedOrder { defaultFrameOrder };
+    std::atomic<int> requestedOverlap { defaultOverlap };
+    
+    // Plan cache: one FFT + window per supported order; 'fft' points into it
+    std::array<std::unique_ptr<FFTWrapper>, numFrameOrders> fftPlans;
+    std::array<float, numFrameOrders> windowSums {};
+    FFTWrapper* fft = nullptr;
     
     // Buffers
-    std::vector<float> inputBuffer;
-    std::vector<float> outputBuffer;
-    std::vector<float> fftData;
+    std::vector<float> inputBuffer;         // mirrored ring, 2 * fftSize: the last fftSize samples are always contiguous
+    std::vector<float> outputBuffer;        // overlap-add ring, fftSize
+    AlignedFloatBuffer fftFrame;            // in-place FFT frame, fft->getFrameBufferSize() floats
+    AlignedFloatBuffer sideFrame;           // second frame for modes with two outputs
+    std::vector<float> percussiveBuffer;    // overlap-add ring of the second output, fftSize
     std::vector<float> magnitude;
     std::vector<float> phase;
     std::vector<float> prevPhase;
-    std::vector<float> phaseAccum;
+    std::vector<float> phaseAccum;          // previous output phase per bin
+    std::vector<float> blurScratch;         // box-filter pass output
+    std::vector<float> blurHistory;         // per-bin temporal blur state
+    
+    // Pitch shift scratch: shifted spectrum and spectral peaks of the current frame
+    std::vector<float> shiftedMagnitude;
+    std::vector<float> shiftedPhase;
+    std::vector<int> peakBins;
+    bool pitchShiftActive = false;          // false -> next shifted frame restarts phase tracking
+    
+    // Formant shift: cepstral envelope of the input and the per-bin gains that
+    // move it, both kept until the input or the shift changes
+    SpectralEnvelope formantEnvelope;
+    std::vector<float> formantGain;
+    float formantGainShift = 0.0f;          // shift formantGain was built for
     
-    // Spectral mask
-    std::vector<float> spectralMask;
+    // Harmonic/percussive split: harmonic share per bin of the current frame
+    HarmonicPercussiveSplitter splitter;
+    std::vector<float> harmonicGain;
+    
+    // Convolution runs in the time domain at its own block size, outside the STFT
+    PartitionedConvolver convolver;
+    
+    // Low-latency masking runs its own band-split STFT with a fixed short latency
+    MultiResolutionSTFT multiResolution;
+    
+    // Cross-synthesis: stored modulator frames (message thread -> audio thread)
+    RealtimeHandoff<CrossSynthesisModulator> modulatorHandoff;
+    CrossSynthesisModulator* modulator = nullptr;
+    int modulatorFrame = 0;
+    std::atomic<float> crossSynthesisAmount { 1.0f };
+    std::vector<float> modulatorSource;     // message-thread mono copy, re-analysed on configuration changes
+    double modulatorSourceRate = 44100.0;
+    
+    // Additive mode renders the scanned column directly as partials, outside the STFT
+    AdditiveOscillatorBank additiveBank;
+    std::atomic<float> additiveLowHz { 30.0f };
+    std::atomic<float> additiveHighHz { 16000.0f };
+    
+    // Frozen frames are resynthesised from the bank without a forward FFT
+    SpectralFreezeBank freezeBank;
+    static constexpr int noFreezeRequest = -2;
+    static constexpr int momentaryFreezeSlot = SpectralFreezeBank::numSlots - 1;
+    std::atomic<int> pendingCapture { noFreezeRequest };
+    std::atomic<int> pendingRecall { noFreezeRequest };
+    std::atomic<float> freezeFadeMs { 50.0f };
+    int captureSlot = noFreezeRequest;      // audio thread: capture in progress
+    bool captureArmed = false;              // first of the two capture frames seen
+    int deferredRecall = noFreezeRequest;   // waits for a capture into the same frame to finish
+    
+    // Mask field (message thread -> audio thread) and the column scanned this hop,
+    // one gain per bin of the current frame
+    RealtimeHandoff<SpectralMaskField> maskHandoff;
+    SpectralMaskField* maskField = nullptr;
+    std::vector<float> targetMask;          // column under the scan position
+    std::vector<float> maskDelta;           // scratch: target - current
+    std::vector<float> spectralMask;        // applied gains, slewed towards targetMask
+    std::atomic<float> maskSlewMs { 25.0f };
+    bool snapMask = true;                   // next update jumps straight to the target
+    bool maskFieldChanged = true;           // a new field arrived: re-render the column
+    bool maskSettled = false;               // spectralMask has reached targetMask
+    float renderedScan = -1.0f;             // scan position targetMask was rendered at
+    
+    // Open stretches of spectralMask as [start, end) bin runs, rebuilt only while
+    // the mask moves; bins between runs are cleared rather than scaled
+    std::vector<int> maskRunStart, maskRunEnd;
+    int numMaskRuns = 0;
+    
+    SpectrumTap spectrumTap;                // written by whichever thread runs processFrame
+    
+    // Message-thread copy of the last mask source, rebuilt when the scale or sample rate changes
+    std::vector<float> maskSource;
+    int maskSourceWidth = 0;                // 0 = maskSource is a 1-D curve (DC first)
+    int maskSourceHeight = 0;
+    SpectralMaskField::FrequencyScale frequencyScale = SpectralMaskField::FrequencyScale::Linear;
+    
+    // Scan position: set from the message thread, advanced per hop at scanRate
+    std::atomic<float> requestedScanPosition { 0.0f };
+    std::atomic<float> scanRate { 0.0f };
+    float lastScanRequest = 0.0f;
+    float scanPosition = 0.0f;
     
     // Parameters
     float blurAmount = 0.0f;
-    bool freezeEnabled = false;
+    float temporalBlurSeconds = 0.0f;
     float pitchShiftFactor = 1.0f;
     float formantShiftAmount = 0.0f;
     
+    // Background frame processing. At most one frame is in flight; all frame state
+    // (effects, mask, freeze) changes hands with it, and the audio thread only
+    // touches that state at a hop boundary with nothing in flight.
+    std::atomic<bool> backgroundRequested { false };
+    bool backgroundActive = false;
+    std::thread worker;
+    std::atomic<bool> workerStop { false };
+    std::mutex workerLock;                  // the audio thread only ever try-locks it
+    std::condition_variable workerWake;
+    LockFreeFIFO<int, 4> frameRequests;     // audio -> worker
+    LockFreeFIFO<int, 4> frameResults;      // worker -> audio
+    AlignedFloatBuffer jobInput;            // frame history handed to the worker
+    AlignedFloatBuffer jobFrame;            // worker FFT frame, time-domain result on return
+    AlignedFloatBuffer jobSideFrame;
+    bool jobInFlight = false;
+    bool jobLate = false;                   // the in-flight frame missed its hop and will be dropped
+    int deferredScanSamples = 0;            // scan time that passed while a frame was still out
+    std::atomic<int> backgroundOverruns { 0 };  // frames dropped because the worker overran
+    
     // Overlap-add state
-    int inputPos = 0;
-    int outputPos = 0;
+    int inputPos = 0;                       // samples into the current hop
+    int outputPos = 0;                      // ring position shared by input and output; hop aligned at each frame
+    float olaGain = 1.0f;                   // hop / sum(window), analysis-window-only OLA
+    float binToAmplitude = 1.0f;            // 2 / sum(window): bin magnitude -> sine amplitude
     
     // Processing functions
-    void processFrame();
-    void applyFrequencyMask();
+    void applyFrameConfig(int order, int framesPerWindow);
+    void receiveHandoffs();
+    void beginHop();
+    void runHop();
+    void processFrame(const float* history, float* frame, float* side);
+    void overlapAdd(const float* frame, const float* side);
+    void startWorker();
+    void stopWorker();
+    void workerLoop();
+    void publishMaskField();
+    void publishModulator();
+    void advanceScan(int elapsedSamples);
+    void updateMask(int elapsedSamples);
+    void rebuildMaskRuns();
+    void applyFrequencyMask(const PackedSpectrum& spectrum);
     void applySpectralBlur();
-    void applySpectralFreeze();
+    void pollFreezeRequests();
+    void applySpectralFreeze(const PackedSpectrum& spectrum);
+    void applyCrossSynthesis(const PackedSpectrum& spectrum);
+    void applyHarmonicPercussive(const PackedSpectrum& spectrum, float* side);
     void applyPitchShift();
-    void applyFormantShift();
+    void applyFormantShift(const PackedSpectrum& spectrum);
     
     // Utilities
     float princArg(float phase);
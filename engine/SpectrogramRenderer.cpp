@@ -0,0 +1,248 @@
+// source/engine/SpectrogramRenderer.cpp
+#include "SpectrogramRenderer.h"
+#include "SampleManager.h"
+#include "../core/FFTWrapper.h"
+#include "../core/AlignedBuffer.h"
+#include "../core/Window.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Runs fn(begin, end, worker) over [0, count) in contiguous chunks, one per thread
+    void parallelFor(int count, int numThreads, const std::function<void(int, int, int)>& fn)
+    {
+        const int workers = juce::jlimit(1, juce::jmax(1, count), numThreads);
+        if (workers == 1)
+        {
+            fn(0, count, 0);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve((size_t)workers);
+        for (int w = 0; w < workers; ++w)
+        {
+            const int begin = (int)((int64_t)count * w / workers);
+            const int end = (int)((int64_t)count * (w + 1) / workers);
+            threads.emplace_back(fn, begin, end, w);
+        }
+
+        for (auto& t : threads)
+            t.join();
+    }
+
+    bool cancelled(const std::atomic<bool>* shouldExit)
+    {
+        return shouldExit != nullptr && shouldExit->load(std::memory_order_relaxed);
+    }
+}
+
+juce::AudioBuffer<float> SpectrogramRenderer::render(const float* brightness, int width, int height,
+                                                     const Settings& settings,
+                                                     const std::atomic<bool>* shouldExit)
+{
+    if (brightness == nullptr || width <= 0 || height <= 0
+        || settings.sampleRate <= 0.0 || settings.durationSeconds <= 0.0)
+        return {};
+
+    const int order = juce::jlimit(8, 14, settings.fftOrder);
+    const int fftSize = 1 << order;
+    const int hop = fftSize / juce::jlimit(2, 16, settings.overlap);
+    const int numBins = fftSize / 2 + 1;
+    const int slotStride = fftSize + 2;         // one packed spectrum, or one time frame
+
+    const int length = (int)std::ceil(settings.durationSeconds * settings.sampleRate);
+    const int numFrames = length / hop + 1;     // frame t is centred on sample t * hop
+    const int padding = fftSize / 2;
+    const int paddedLength = numFrames * hop + fftSize;
+
+    const int numThreads = settings.numThreads > 0 ? settings.numThreads
+                                                   : (int)juce::jmax(1u, std::thread::hardware_concurrency());
+
+    // Target magnitudes: one column per frame through the live mask's row mapping
+    const SpectralMaskField::Mapping mapping { settings.scale, settings.sampleRate, numBins, numBins };
+    auto field = SpectralMaskField::fromImage(brightness, width, height, mapping);
+    if (field == nullptr)
+        return {};
+
+    std::vector<float> magnitude((size_t)numFrames * (size_t)numBins);
+    const float range = juce::jmax(1.0f, settings.dynamicRangeDb);
+    for (int t = 0; t < numFrames; ++t)
+    {
+        float* column = magnitude.data() + (size_t)t * (size_t)numBins;
+        field->renderColumn(numFrames > 1 ? (float)t / (float)(numFrames - 1) : 0.0f, column, numBins);
+
+        for (int k = 0; k < numBins; ++k)
+            column[k] = column[k] > 0.0f ? juce::Decibels::decibelsToGain((juce::jmin(column[k], 1.0f) - 1.0f) * range)
+                                         : 0.0f;
+    }
+
+    // Hann analysis and synthesis; the inverse divides by the summed squared window
+    const auto window = makeWindow((size_t)fftSize, WindowType::Hann);
+    std::vector<float> inverseNorm((size_t)paddedLength, 0.0f);
+    for (int t = 0; t < numFrames; ++t)
+        for (int n = 0; n < fftSize; ++n)
+            inverseNorm[(size_t)(t * hop + n)] += window[(size_t)n] * window[(size_t)n];
+    for (auto& v : inverseNorm)
+        v = v > 1.0e-3f ? 1.0f / v : 0.0f;
+
+    // Per-thread FFT plans and in-place scratch frames
+    std::vector<std::unique_ptr<FFTWrapper>> plans;
+    std::vector<std::unique_ptr<AlignedFloatBuffer>> scratch;
+    for (int w = 0; w < numThreads; ++w)
+    {
+        plans.push_back(std::make_unique<FFTWrapper>(order));
+        scratch.push_back(std::make_unique<AlignedFloatBuffer>((size_t)(2 * fftSize)));
+    }
+
+    // slots: the current estimate X per frame, then its time frame after the inverse
+    std::vector<float> slots((size_t)numFrames * (size_t)slotStride);
+    std::vector<float> previous((size_t)numFrames * (size_t)slotStride);  // last projection T
+    std::vector<float> signal((size_t)paddedLength);
+
+    // Random starting phases (fixed seed, so renders repeat)
+    {
+        juce::Random random(0x5eed);
+        for (int t = 0; t < numFrames; ++t)
+        {
+            float* spectrum = slots.data() + (size_t)t * (size_t)slotStride;
+            const float* mag = magnitude.data() + (size_t)t * (size_t)numBins;
+            for (int k = 0; k < numBins; ++k)
+            {
+                const float phi = juce::MathConstants<float>::twoPi * random.nextFloat();
+                spectrum[2 * k] = mag[k] * std::cos(phi);
+                spectrum[2 * k + 1] = mag[k] * std::sin(phi);
+            }
+        }
+        std::copy(slots.begin(), slots.end(), previous.begin());
+    }
+
+    // X -> time signal. Frames invert independently; the overlap-add is split by hop blocks.
+    const auto inverse = [&]
+    {
+        parallelFor(numFrames, numThreads, [&](int begin, int end, int worker)
+        {
+            float* frame = scratch[(size_t)worker]->data();
+            for (int t = begin; t < end; ++t)
+            {
+                float* slot = slots.data() + (size_t)t * (size_t)slotStride;
+                std::copy(slot, slot + slotStride, frame);
+                plans[(size_t)worker]->inverseInPlace(frame);
+                juce::FloatVectorOperations::multiply(slot, frame, window.data(), fftSize);
+            }
+        });
+
+        const int numBlocks = paddedLength / hop;
+        parallelFor(numBlocks, numThreads, [&](int begin, int end, int)
+        {
+            for (int b = begin; b < end; ++b)
+            {
+                float* out = signal.data() + (size_t)b * (size_t)hop;
+                juce::FloatVectorOperations::clear(out, hop);
+
+                // Frames starting within one window before this block reach into it
+                for (int t = juce::jmax(0, b - fftSize / hop + 1); t <= juce::jmin(b, numFrames - 1); ++t)
+                    juce::FloatVectorOperations::add(out, slots.data() + (size_t)t * (size_t)slotStride + (size_t)((b - t) * hop), hop);
+
+                juce::FloatVectorOperations::multiply(out, inverseNorm.data() + (size_t)b * (size_t)hop, hop);
+            }
+        });
+    };
+
+    // Time signal -> STFT, projected onto the target magnitudes, with momentum
+    const float momentum = juce::jlimit(0.0f, 1.0f, settings.momentum);
+    const auto forwardAndProject = [&]
+    {
+        parallelFor(numFrames, numThreads, [&](int begin, int end, int worker)
+        {
+            float* frame = scratch[(size_t)worker]->data();
+            for (int t = begin; t < end; ++t)
+            {
+                juce::FloatVectorOperations::multiply(frame, signal.data() + (size_t)t * (size_t)hop, window.data(), fftSize);
+                const auto spectrum = plans[(size_t)worker]->forwardInPlace(frame);
+
+                float* x = slots.data() + (size_t)t * (size_t)slotStride;
+                float* last = previous.data() + (size_t)t * (size_t)slotStride;
+                const float* mag = magnitude.data() + (size_t)t * (size_t)numBins;
+
+                for (int k = 0; k < numBins; ++k)
+                {
+                    const float re = spectrum.re(k), im = spectrum.im(k);
+                    const float norm = std::sqrt(re * re + im * im);
+                    const float projRe = norm > 1.0e-12f ? mag[k] * re / norm : mag[k];
+                    const float projIm = norm > 1.0e-12f ? mag[k] * im / norm : 0.0f;
+
+                    x[2 * k] = projRe + momentum * (projRe - last[2 * k]);
+                    x[2 * k + 1] = projIm + momentum * (projIm - last[2 * k + 1]);
+                    last[2 * k] = projRe;
+                    last[2 * k + 1] = projIm;
+                }
+            }
+        });
+    };
+
+    for (int i = 0; i < settings.iterations; ++i)
+    {
+        if (cancelled(shouldExit))
+            return {};
+
+        inverse();
+        forwardAndProject();
+    }
+
+    // Final signal from the last consistent projection
+    std::copy(previous.begin(), previous.end(), slots.begin());
+    inverse();
+
+    if (cancelled(shouldExit))
+        return {};
+
+    juce::AudioBuffer<float> result(1, length);
+    result.copyFrom(0, 0, signal.data() + padding, length);
+
+    const float peak = result.getMagnitude(0, 0, length);
+    if (peak > 0.0f)
+        result.applyGain(juce::Decibels::decibelsToGain(-1.0f) / peak);
+
+    return result;
+}
+
+bool SpectrogramRenderer::renderToSample(SampleManager& samples, int slot,
+                                         const float* brightness, int width, int height,
+                                         const Settings& settings,
+                                         const std::atomic<bool>* shouldExit)
+{
+    const auto audio = render(brightness, width, height, settings, shouldExit);
+    if (audio.getNumSamples() == 0)
+        return false;
+
+    return samples.loadSample(slot, audio, settings.sampleRate);
+}
+
+bool SpectrogramRenderer::renderToFile(const juce::File& file,
+                                       const float* brightness, int width, int height,
+                                       const Settings& settings,
+                                       const std::atomic<bool>* shouldExit)
+{
+    const auto audio = render(brightness, width, height, settings, shouldExit);
+    if (audio.getNumSamples() == 0)
+        return false;
+
+    file.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+    if (stream == nullptr)
+        return false;
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), settings.sampleRate,
+                                                                        1, 24, {}, 0));
+    if (writer == nullptr)
+        return false;
+
+    stream.release(); // the writer owns the stream now
+    return writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+}
@@ -0,0 +1,53 @@
+// source/engine/SpectrogramRenderer.h
+#pragma once
+#include "SpectralMaskField.h"
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <atomic>
+
+class SampleManager;
+
+// Offline "render this picture to audio". The image is read as a magnitude
+// spectrogram (columns = time across the whole duration, rows = frequency
+// through the same row mappings as the live mask) and the phases are
+// reconstructed with fast Griffin-Lim: alternating inverse and forward STFTs
+// with a momentum step. Every pass is split over frames across all cores, so
+// a long image renders in seconds rather than at real-time speed. Not for
+// the audio thread: allocates and blocks until done.
+class SpectrogramRenderer
+{
+public:
+    struct Settings
+    {
+        double sampleRate = 44100.0;
+        double durationSeconds = 10.0;          // the image width spans this
+        int fftOrder = 11;                      // 2048-sample frames
+        int overlap = 4;                        // frames per window
+        int iterations = 32;
+        float momentum = 0.99f;                 // fast Griffin-Lim acceleration, 0 = classic
+        float dynamicRangeDb = 60.0f;           // brightness 1 = 0 dB, brightness -> 0 fades to -range
+        SpectralMaskField::FrequencyScale scale = SpectralMaskField::FrequencyScale::Linear;
+        int numThreads = 0;                     // 0 = one per core
+    };
+
+    // brightness: width * height values, row-major, row 0 at the top. Returns a
+    // mono buffer peak-normalised to -1 dBFS, or an empty buffer on bad input
+    // or when shouldExit is set part-way.
+    static juce::AudioBuffer<float> render(const float* brightness, int width, int height,
+                                           const Settings& settings,
+                                           const std::atomic<bool>* shouldExit = nullptr);
+
+    // Renders straight into a SampleManager slot at settings.sampleRate
+    static bool renderToSample(SampleManager& samples, int slot,
+                               const float* brightness, int width, int height,
+                               const Settings& settings,
+                               const std::atomic<bool>* shouldExit = nullptr);
+
+    // Renders to a 24-bit WAV file, replacing it if it exists
+    static bool renderToFile(const juce::File& file,
+                             const float* brightness, int width, int height,
+                             const Settings& settings,
+                             const std::atomic<bool>* shouldExit = nullptr);
+
+private:
+    SpectrogramRenderer() = delete;
+};
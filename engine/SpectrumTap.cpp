@@ -0,0 +1,61 @@
+// source/engine/SpectrumTap.cpp
+#include "SpectrumTap.h"
+#include <cmath>
+
+void SpectrumTap::setEnabled(bool shouldBeEnabled) noexcept
+{
+    if (shouldBeEnabled && !enabled.load(std::memory_order_relaxed))
+    {
+        Column stale;
+        while (columns.pop(stale)) {}
+    }
+    enabled.store(shouldBeEnabled, std::memory_order_relaxed);
+}
+
+void SpectrumTap::prepare(double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    samplesUntilColumn = 0;
+    edgesForBins = 0;
+}
+
+void SpectrumTap::updateBandEdges(int numBins) noexcept
+{
+    // Band b starts at lowestHz * (nyquist / lowestHz)^(b / numBands)
+    const double nyquist = 0.5 * sampleRate;
+    const double binsPerHz = (double)(numBins - 1) / nyquist;
+    const double ratio = nyquist / (double)lowestHz;
+    for (int b = 0; b <= numBands; ++b)
+    {
+        const double hz = (double)lowestHz * std::pow(ratio, (double)b / (double)numBands);
+        bandEdges[(size_t)b] = juce::jlimit(1, numBins, (int)std::lround(hz * binsPerHz));
+    }
+    edgesForBins = numBins;
+}
+
+void SpectrumTap::push(const PackedSpectrum& spectrum, float amplitudeScale, int elapsedSamples) noexcept
+{
+    if (!enabled.load(std::memory_order_relaxed))
+        return;
+
+    samplesUntilColumn -= elapsedSamples;
+    if (samplesUntilColumn > 0)
+        return;
+    samplesUntilColumn = juce::jmax(0, samplesUntilColumn + (int)(sampleRate / columnsPerSecond));
+
+    if (spectrum.numBins != edgesForBins)
+        updateBandEdges(spectrum.numBins);
+
+    // Peak per band; bands narrower than a bin repeat the bin they fall in
+    for (int b = 0; b < numBands; ++b)
+    {
+        const int lo = juce::jmin(bandEdges[(size_t)b], spectrum.numBins - 1);
+        const int hi = juce::jmax(bandEdges[(size_t)b + 1], lo + 1);
+        float peak = 0.0f;
+        for (int k = lo; k < hi; ++k)
+            peak = juce::jmax(peak, spectrum.re(k) * spectrum.re(k) + spectrum.im(k) * spectrum.im(k));
+        scratch.amplitude[(size_t)b] = std::sqrt(peak) * amplitudeScale;
+    }
+
+    columns.push(scratch); // full: the reader is behind, drop this column
+}
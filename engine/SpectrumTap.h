@@ -0,0 +1,49 @@
+// source/engine/SpectrumTap.h
+#pragma once
+#include "../core/FFTWrapper.h"
+#include "../core/LockFreeFIFO.h"
+#include <array>
+#include <atomic>
+
+// Analysis tap for displays. Processed frames are reduced to numBands
+// log-spaced bands (the peak amplitude in each) and handed to a single reader
+// through a wait-free FIFO; when the reader falls behind, columns are dropped
+// rather than waited for. Nothing is computed while no reader is attached, and
+// at most columnsPerSecond frames are reduced while one is, so the frame thread
+// pays one pass over the bins every few hops.
+class SpectrumTap
+{
+public:
+    static constexpr int numBands = 256;
+    static constexpr int columnsPerSecond = 120;
+    static constexpr float lowestHz = 20.0f;
+
+    struct Column
+    {
+        std::array<float, numBands> amplitude {}; // linear, 1 = full-scale sine; band 0 is the lowest
+    };
+
+    // Reader (message thread). Enabling drops whatever was left from the last session.
+    void setEnabled(bool shouldBeEnabled) noexcept;
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+    bool pop(Column& column) noexcept { return columns.pop(column); }
+
+    // Frame thread: call before frames are pushed
+    void prepare(double sampleRate) noexcept;
+
+    // Frame thread: one processed frame. amplitudeScale maps bin magnitude to
+    // sine amplitude (2 / window sum); elapsedSamples is the hop since the last frame.
+    void push(const PackedSpectrum& spectrum, float amplitudeScale, int elapsedSamples) noexcept;
+
+private:
+    void updateBandEdges(int numBins) noexcept;
+
+    LockFreeFIFO<Column, 64> columns;
+    std::atomic<bool> enabled { false };
+
+    double sampleRate = 44100.0;
+    int samplesUntilColumn = 0;
+    int edgesForBins = 0;                         // bin count bandEdges was built for
+    std::array<int, numBands + 1> bandEdges {};   // first bin of each band
+    Column scratch;
+};
@@ -0,0 +1,223 @@
+#include "CPUImageReader.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+    constexpr double lumaR = 0.2126;
+    constexpr double lumaG = 0.7152;
+    constexpr double lumaB = 0.0722;
+}
+
+CPUImageReader::CPUImageReader(int numThreads) {
+    int n = numThreads > 0 ? numThreads : (int)std::thread::hardware_concurrency() / 2;
+    n = std::clamp(n, 1, maxThreads);
+
+    helpers.reserve((size_t)(n - 1));
+    for (int i = 1; i < n; ++i) {
+        helpers.emplace_back(&CPUImageReader::helperLoop, this, i);
+    }
+}
+
+CPUImageReader::~CPUImageReader() {
+    // The reader thread calls analyzeFrame, so it has to stop before the pool goes
+    stop();
+
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        quit = true;
+    }
+    poolWake.notify_all();
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+}
+
+void CPUImageReader::submitFrame(const uint8_t* rgba, int frameWidth, int frameHeight, size_t rowBytes) {
+    if (rgba == nullptr || frameWidth <= 0 || frameHeight <= 0) return;
+
+    const size_t packedRow = (size_t)frameWidth * 4;
+    std::lock_guard<std::mutex> guard(frameLock);
+
+    // The two frame buffers alternate, so once sized this does not allocate
+    incoming.pixels.resize(packedRow * (size_t)frameHeight);
+    for (int y = 0; y < frameHeight; ++y) {
+        std::memcpy(incoming.pixels.data() + (size_t)y * packedRow, rgba + (size_t)y * rowBytes, packedRow);
+    }
+    incoming.width = frameWidth;
+    incoming.height = frameHeight;
+    hasIncoming = true;
+}
+
+void CPUImageReader::analyzeFrame(ImageModData& data) {
+    bool fresh = false;
+    {
+        std::lock_guard<std::mutex> guard(frameLock);
+        if (hasIncoming) {
+            std::swap(current, incoming);
+            hasIncoming = false;
+            fresh = true;
+        }
+    }
+
+    // An unchanged frame has unchanged features: republish them at the same rate
+    if (fresh) {
+        const int slices = getNumThreads();
+        {
+            std::lock_guard<std::mutex> guard(poolLock);
+            ++jobGeneration;
+            slicesRemaining = slices - 1;
+        }
+        poolWake.notify_all();
+
+        runSlice(0);
+        {
+            std::unique_lock<std::mutex> guard(poolLock);
+            poolDone.wait(guard, [this] { return slicesRemaining == 0; });
+        }
+
+        Partial total;
+        for (int i = 0; i < slices; ++i) {
+            for (int s = 0; s < numStrips; ++s) {
+                total.r[(size_t)s] += partials[(size_t)i].r[(size_t)s];
+                total.g[(size_t)s] += partials[(size_t)i].g[(size_t)s];
+                total.b[(size_t)s] += partials[(size_t)i].b[(size_t)s];
+            }
+        }
+        finish(total, current.width, current.height, lastResult);
+    }
+
+    const uint64_t frameNumber = data.frameNumber;
+    data = lastResult;
+    data.frameNumber = frameNumber;
+}
+
+void CPUImageReader::helperLoop(int index) {
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(poolLock);
+            poolWake.wait(guard, [&] { return quit || jobGeneration != seenGeneration; });
+            if (quit) return;
+            seenGeneration = jobGeneration;
+        }
+
+        runSlice(index);
+
+        bool last = false;
+        {
+            std::lock_guard<std::mutex> guard(poolLock);
+            last = --slicesRemaining == 0;
+        }
+        if (last) poolDone.notify_one();
+    }
+}
+
+void CPUImageReader::runSlice(int index) {
+    const int slices = getNumThreads();
+    const int firstRow = current.height * index / slices;
+    const int endRow = current.height * (index + 1) / slices;
+
+    auto& partial = partials[(size_t)index];
+    partial = {};
+    sumRows(current.pixels.data(), current.width, (size_t)current.width * 4, firstRow, endRow, partial);
+}
+
+void CPUImageReader::sumRows(const uint8_t* rgba, int frameWidth, size_t rowBytes,
+                             int firstRow, int endRow, Partial& partial) {
+    for (int y = firstRow; y < endRow; ++y) {
+        const uint8_t* row = rgba + (size_t)y * rowBytes;
+        for (int s = 0; s < numStrips; ++s) {
+            const int x0 = stripStart(s, frameWidth);
+            const int x1 = stripStart(s + 1, frameWidth);
+
+            // Branch-free 8-bit reductions: this is the loop that vectorises
+            uint32_t r = 0, g = 0, b = 0;
+            for (int x = x0; x < x1; ++x) {
+                r += row[4 * x];
+                g += row[4 * x + 1];
+                b += row[4 * x + 2];
+            }
+            partial.r[(size_t)s] += r;
+            partial.g[(size_t)s] += g;
+            partial.b[(size_t)s] += b;
+        }
+    }
+}
+
+void CPUImageReader::finish(const Partial& total, int frameWidth, int frameHeight, ImageModData& data) {
+    const uint64_t frameNumber = data.frameNumber;
+    data.reset();
+    data.frameNumber = frameNumber;
+    if (frameWidth <= 0 || frameHeight <= 0) return;
+
+    uint64_t r = 0, g = 0, b = 0;
+    for (int s = 0; s < numStrips; ++s) {
+        r += total.r[(size_t)s];
+        g += total.g[(size_t)s];
+        b += total.b[(size_t)s];
+    }
+
+    const double scale = 1.0 / (255.0 * (double)frameWidth * (double)frameHeight);
+    data.centerR = (float)((double)r * scale);
+    data.centerG = (float)((double)g * scale);
+    data.centerB = (float)((double)b * scale);
+    data.brightness = (float)((lumaR * (double)r + lumaG * (double)g + lumaB * (double)b) * scale);
+
+    for (int s = 0; s < numStrips; ++s) {
+        const int source = coveringStrip(s, frameWidth);
+        const int columns = stripStart(source + 1, frameWidth) - stripStart(source, frameWidth);
+        const double luma = lumaR * (double)total.r[(size_t)source]
+                          + lumaG * (double)total.g[(size_t)source]
+                          + lumaB * (double)total.b[(size_t)source];
+        data.densityCurve[(size_t)s] = (float)(luma / (255.0 * (double)columns * (double)frameHeight));
+    }
+}
+
+void CPUImageReader::analyzeReference(const uint8_t* rgba, int frameWidth, int frameHeight,
+                                      size_t rowBytes, ImageModData& data) {
+    const uint64_t frameNumber = data.frameNumber;
+    data.reset();
+    data.frameNumber = frameNumber;
+    if (rgba == nullptr || frameWidth <= 0 || frameHeight <= 0) return;
+
+    double sumR = 0.0, sumG = 0.0, sumB = 0.0;
+    std::array<double, numStrips> stripLuma{};
+    std::array<int, numStrips> stripColumns{};
+
+    for (int x = 0; x < frameWidth; ++x) {
+        int strip = 0;
+        while (stripStart(strip + 1, frameWidth) <= x) ++strip;
+        ++stripColumns[(size_t)strip];
+
+        for (int y = 0; y < frameHeight; ++y) {
+            const uint8_t* pixel = rgba + (size_t)y * rowBytes + (size_t)x * 4;
+            const double r = pixel[0] / 255.0, g = pixel[1] / 255.0, b = pixel[2] / 255.0;
+            sumR += r;
+            sumG += g;
+            sumB += b;
+            stripLuma[(size_t)strip] += lumaR * r + lumaG * g + lumaB * b;
+        }
+    }
+
+    const double pixels = (double)frameWidth * (double)frameHeight;
+    data.centerR = (float)(sumR / pixels);
+    data.centerG = (float)(sumG / pixels);
+    data.centerB = (float)(sumB / pixels);
+    data.brightness = (float)((lumaR * sumR + lumaG * sumG + lumaB * sumB) / pixels);
+
+    for (int s = 0; s < numStrips; ++s) {
+        const int source = coveringStrip(s, frameWidth);
+        data.densityCurve[(size_t)s] = (float)(stripLuma[(size_t)source] / ((double)stripColumns[(size_t)source] * frameHeight));
+    }
+}
+
+int CPUImageReader::coveringStrip(int strip, int frameWidth) {
+    if (stripStart(strip, frameWidth) < stripStart(strip + 1, frameWidth)) return strip;
+
+    // An empty strip shows the strip holding the column under its centre
+    const int column = (2 * strip + 1) * frameWidth / (2 * numStrips);
+    int source = 0;
+    while (stripStart(source + 1, frameWidth) <= column) ++source;
+    return source;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "GPUImageReader.h"
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// GPUImageReader for machines without a GPU (headless render nodes). Frames are
+// handed in as 8-bit RGBA, the layout a colour-box FBO reads back as, and the
+// features are computed on the CPU with the rows split across a small pool.
+//
+// Features, all in 0..1:
+//   brightness       mean Rec. 709 luminance
+//   centerR/G/B      mean of each channel
+//   densityCurve[i]  mean luminance of the i-th of 16 equal vertical strips
+//
+// The hot loop sums 8-bit channels into integers per strip, which compilers
+// vectorise, and integer sums make the result independent of how the rows are
+// split. analyzeReference() is the plain per-pixel version the pool must match.
+class CPUImageReader : public GPUImageReader {
+public:
+    static constexpr int maxThreads = 8;
+
+    // numThreads <= 0 picks half the hardware threads, at most maxThreads
+    explicit CPUImageReader(int numThreads = 0);
+    ~CPUImageReader() override;
+
+    // Any thread. Copies the frame; the reader analyses the latest one submitted
+    // and keeps publishing it until a new one arrives.
+    void submitFrame(const uint8_t* rgba, int frameWidth, int frameHeight, size_t rowBytes);
+
+    int getNumThreads() const { return (int)helpers.size() + 1; }
+
+    static void analyzeReference(const uint8_t* rgba, int frameWidth, int frameHeight,
+                                 size_t rowBytes, ImageModData& data);
+
+protected:
+    void analyzeFrame(ImageModData& data) override;
+
+private:
+    static constexpr int numStrips = 16;
+
+    // Integer channel sums over a band of rows, per vertical strip
+    struct Partial {
+        std::array<uint64_t, numStrips> r{};
+        std::array<uint64_t, numStrips> g{};
+        std::array<uint64_t, numStrips> b{};
+    };
+
+    struct Frame {
+        std::vector<uint8_t> pixels;   // tightly packed RGBA
+        int width{0};
+        int height{0};
+    };
+
+    // Strips partition the columns; frames narrower than numStrips leave some empty
+    static int stripStart(int strip, int frameWidth) { return strip * frameWidth / numStrips; }
+    static int coveringStrip(int strip, int frameWidth);
+    static void sumRows(const uint8_t* rgba, int frameWidth, size_t rowBytes,
+                        int firstRow, int endRow, Partial& partial);
+    static void finish(const Partial& total, int frameWidth, int frameHeight, ImageModData& data);
+
+    void helperLoop(int index);
+    void runSlice(int index);
+
+    // Frame hand-over: submitFrame fills incoming, analyzeFrame swaps it in
+    std::mutex frameLock;
+    Frame incoming;                    // guarded by frameLock
+    bool hasIncoming{false};           // guarded by frameLock
+    Frame current;                     // reader thread
+    ImageModData lastResult;           // reader thread
+
+    // Pool: the reader thread takes slice 0, helpers the others
+    std::vector<std::thread> helpers;
+    std::array<Partial, maxThreads> partials;
+    std::mutex poolLock;
+    std::condition_variable poolWake;
+    std::condition_variable poolDone;
+    uint64_t jobGeneration{0};         // guarded by poolLock
+    int slicesRemaining{0};            // guarded by poolLock
+    bool quit{false};                  // guarded by poolLock
+};
@@ -0,0 +1,207 @@
+// source/plugin/ImageLoader.cpp
+#include "ImageLoader.h"
+#include <cmath>
+#include <utility>
+
+juce::Rectangle<int> TiledImage::getTileBounds(int tx, int ty) const
+{
+    const int x = tx * tileSize;
+    const int y = ty * tileSize;
+    return { x, y, juce::jmin(tileSize, width - x), juce::jmin(tileSize, height - y) };
+}
+
+ImageLoader::ImageLoader()
+{
+    worker = std::thread([this] { workerLoop(); });
+}
+
+ImageLoader::~ImageLoader()
+{
+    {
+        const std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+        ++requestedGeneration; // stages still running see they are stale and stop
+    }
+    wake.notify_one();
+    worker.join();
+    cancelPendingUpdate();
+}
+
+void ImageLoader::load(const juce::File& file)
+{
+    {
+        const std::lock_guard<std::mutex> guard(lock);
+        requestedFile = file;
+        ++requestedGeneration;
+        pending = {};
+    }
+    loading = true;
+    wake.notify_one();
+}
+
+void ImageLoader::cancel()
+{
+    {
+        const std::lock_guard<std::mutex> guard(lock);
+        requestedFile = juce::File();
+        ++requestedGeneration;
+        pending = {};
+    }
+    loading = false;
+}
+
+void ImageLoader::workerLoop()
+{
+    for (;;)
+    {
+        juce::File file;
+        uint64_t generation = 0;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return quit || requestedGeneration.load() != startedGeneration; });
+            if (quit)
+                return;
+
+            generation = startedGeneration = requestedGeneration.load();
+            file = requestedFile;
+        }
+
+        if (file.getFullPathName().isNotEmpty())
+            decode(file, generation);
+    }
+}
+
+void ImageLoader::decode(const juce::File& file, uint64_t generation)
+{
+    auto image = juce::ImageFileFormat::loadFrom(file);
+    if (!image.isValid())
+    {
+        post(generation, file, [](Results& results) { results.failed = true; });
+        return;
+    }
+
+    // Coarse first: the preview is one resample of the decoded bitmap
+    const int fullWidth = image.getWidth(), fullHeight = image.getHeight();
+    auto preview = downscaled(image, previewSize);
+    post(generation, file, [&](Results& results)
+    {
+        results.preview = preview;
+        results.fullWidth = fullWidth;
+        results.fullHeight = fullHeight;
+    });
+
+    // Beyond the analysis size the full resolution lives on only as tiles
+    if (juce::jmax(fullWidth, fullHeight) > maxAnalysisSize)
+    {
+        if (!isCurrent(generation))
+            return;
+
+        auto tiles = split(image);
+        post(generation, file, [&](Results& results) { results.tiles = tiles; });
+        image = downscaled(image, maxAnalysisSize);
+    }
+
+    if (!isCurrent(generation))
+        return;
+
+    auto scanner = std::make_unique<ImageScanner>();
+    scanner->loadImage(image);
+    post(generation, file, [&](Results& results) { results.scanner = std::move(scanner); });
+}
+
+template <typename Fill>
+void ImageLoader::post(uint64_t generation, const juce::File& file, Fill&& fill)
+{
+    {
+        const std::lock_guard<std::mutex> guard(lock);
+        if (!isCurrent(generation))
+            return;
+
+        if (pending.generation != generation)
+        {
+            pending = {};
+            pending.generation = generation;
+            pending.file = file;
+        }
+        fill(pending);
+    }
+    triggerAsyncUpdate();
+}
+
+void ImageLoader::handleAsyncUpdate()
+{
+    // Take whatever stages have arrived; later ones trigger another update
+    Results results;
+    {
+        const std::lock_guard<std::mutex> guard(lock);
+        if (pending.generation == 0 || !isCurrent(pending.generation))
+            return;
+
+        results.file = pending.file;
+        results.preview = std::exchange(pending.preview, {});
+        results.fullWidth = pending.fullWidth;
+        results.fullHeight = pending.fullHeight;
+        results.tiles = std::move(pending.tiles);
+        results.scanner = std::move(pending.scanner);
+        results.failed = std::exchange(pending.failed, false);
+    }
+
+    if (results.failed)
+    {
+        loading = false;
+        if (onFailed)
+            onFailed(results.file);
+        return;
+    }
+
+    if (results.preview.isValid() && onPreview)
+        onPreview(results.preview, results.fullWidth, results.fullHeight);
+
+    if (results.tiles != nullptr && onTiles)
+        onTiles(results.tiles);
+
+    if (results.scanner != nullptr)
+    {
+        loading = false;
+        if (onScanner)
+            onScanner(std::move(results.scanner), results.file);
+    }
+}
+
+juce::Image ImageLoader::downscaled(const juce::Image& image, int maxSize)
+{
+    const int longest = juce::jmax(image.getWidth(), image.getHeight());
+    if (longest <= maxSize)
+        return image;
+
+    const double scale = (double)maxSize / (double)longest;
+    return image.rescaled(juce::jmax(1, (int)std::lround(image.getWidth() * scale)),
+                          juce::jmax(1, (int)std::lround(image.getHeight() * scale)),
+                          juce::Graphics::mediumResamplingQuality);
+}
+
+std::shared_ptr<const TiledImage> ImageLoader::split(const juce::Image& image)
+{
+    auto tiled = std::make_shared<TiledImage>();
+    tiled->width = image.getWidth();
+    tiled->height = image.getHeight();
+    tiled->tilesX = (tiled->width + TiledImage::tileSize - 1) / TiledImage::tileSize;
+    tiled->tilesY = (tiled->height + TiledImage::tileSize - 1) / TiledImage::tileSize;
+    tiled->tiles.reserve((size_t)(tiled->tilesX * tiled->tilesY));
+
+    // Each tile owns a copy of its pixels, so the decoded bitmap can be freed
+    for (int ty = 0; ty < tiled->tilesY; ++ty)
+    {
+        for (int tx = 0; tx < tiled->tilesX; ++tx)
+        {
+            const auto bounds = tiled->getTileBounds(tx, ty);
+            juce::Image tile(image.getFormat(), bounds.getWidth(), bounds.getHeight(), true);
+            {
+                juce::Graphics g(tile);
+                g.drawImageAt(image, -bounds.getX(), -bounds.getY());
+            }
+            tiled->tiles.push_back(tile);
+        }
+    }
+    return tiled;
+}
@@ -0,0 +1,94 @@
+// source/plugin/ImageLoader.h
+#pragma once
+#include <juce_graphics/juce_graphics.h>
+#include <juce_events/juce_events.h>
+#include "ImageScanner.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Full-resolution image held as tiles of at most tileSize pixels, so no single
+// bitmap has to cover a very large canvas
+struct TiledImage
+{
+    static constexpr int tileSize = 1024;
+
+    int width = 0;
+    int height = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    std::vector<juce::Image> tiles;     // row-major, tilesX * tilesY
+
+    const juce::Image& getTile(int tx, int ty) const { return tiles[(size_t)(ty * tilesX + tx)]; }
+    juce::Rectangle<int> getTileBounds(int tx, int ty) const;
+};
+
+// Decodes and analyses images on a background thread. Each load is delivered
+// in stages on the message thread, coarse first:
+//   onPreview  - a copy at most previewSize pixels on its longest side, as soon
+//                as the file is decoded
+//   onTiles    - only for images larger than maxAnalysisSize: the full
+//                resolution as a TiledImage
+//   onScanner  - an ImageScanner with its planes, pyramid and tables built, from
+//                the image reduced to at most maxAnalysisSize on its longest side
+// A new load supersedes the one in progress: its remaining stages are dropped.
+// The decoders still need the whole bitmap once, but it is released after tiling.
+// Destruction waits for a decode in progress to finish.
+class ImageLoader : private juce::AsyncUpdater
+{
+public:
+    static constexpr int previewSize = 1024;
+    static constexpr int maxAnalysisSize = 8192;
+
+    ImageLoader();
+    ~ImageLoader() override;
+
+    // Message thread
+    void load(const juce::File& file);
+    void cancel();
+    bool isLoading() const { return loading; }
+
+    std::function<void(const juce::Image& preview, int fullWidth, int fullHeight)> onPreview;
+    std::function<void(std::shared_ptr<const TiledImage> tiles)> onTiles;
+    std::function<void(std::unique_ptr<ImageScanner> scanner, const juce::File& file)> onScanner;
+    std::function<void(const juce::File& file)> onFailed;
+
+private:
+    struct Results
+    {
+        uint64_t generation = 0;
+        juce::File file;
+        juce::Image preview;
+        int fullWidth = 0;
+        int fullHeight = 0;
+        std::shared_ptr<const TiledImage> tiles;
+        std::unique_ptr<ImageScanner> scanner;
+        bool failed = false;
+    };
+
+    void handleAsyncUpdate() override;
+    void workerLoop();
+    void decode(const juce::File& file, uint64_t generation);
+    bool isCurrent(uint64_t generation) const { return generation == requestedGeneration.load(); }
+    template <typename Fill> void post(uint64_t generation, const juce::File& file, Fill&& fill);
+
+    static juce::Image downscaled(const juce::Image& image, int maxSize);
+    static std::shared_ptr<const TiledImage> split(const juce::Image& image);
+
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool quit = false;                       // guarded by lock
+    juce::File requestedFile;                // guarded by lock
+    std::atomic<uint64_t> requestedGeneration { 0 };
+    uint64_t startedGeneration = 0;          // worker thread
+
+    Results pending;                         // guarded by lock
+    bool loading = false;                    // message thread
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImageLoader)
+};
@@ -1,55 +1,424 @@
 // source/plugin/ImageScanner.cpp
 #include "ImageScanner.h"
+#include <cmath>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace
+{
+    // Rec. 709 luma weights
+    constexpr float lumaRed = 0.2126f;
+    constexpr float lumaGreen = 0.7152f;
+    constexpr float lumaBlue = 0.0722f;
+
+    // One image row into the colour planes. Premultiplied ARGB is already
+    // composited over black; a single-channel image is grey at its alpha.
+    template <typename Pixel>
+    void readRow(const uint8_t* line, int pixelStride, int width, float* r, float* g, float* b)
+    {
+        constexpr float scale = 1.0f / 255.0f;
+        for (int x = 0; x < width; ++x, line += pixelStride)
+        {
+            const auto* pixel = reinterpret_cast<const Pixel*>(line);
+            if constexpr (std::is_same_v<Pixel, juce::PixelAlpha>)
+            {
+                r[x] = g[x] = b[x] = (float)pixel->getAlpha() * scale;
+            }
+            else
+            {
+                r[x] = (float)pixel->getRed() * scale;
+                g[x] = (float)pixel->getGreen() * scale;
+                b[x] = (float)pixel->getBlue() * scale;
+            }
+        }
+    }
+
+    // Linear resampling: dst[i] = src at position start + i * step, clamped to the ends
+    void resample(const float* src, int srcLength, float* dst, int n, float start, float step)
+    {
+        if (n == srcLength && start == 0.0f && step == 1.0f)
+        {
+            juce::FloatVectorOperations::copy(dst, src, n);
+            return;
+        }
+
+        const float last = (float)(srcLength - 1);
+        for (int i = 0; i < n; ++i)
+        {
+            const float position = juce::jlimit(0.0f, last, start + (float)i * step);
+            const int i0 = (int)position;
+            const int i1 = juce::jmin(i0 + 1, srcLength - 1);
+            dst[i] = src[i0] + (position - (float)i0) * (src[i1] - src[i0]);
+        }
+    }
+}
+
+ImageScanner::ImageScanner() = default;
+ImageScanner::~ImageScanner() = default;
 
 bool ImageScanner::loadImage(const juce::File& file)
 {
-    auto image = juce::ImageFileFormat::loadFrom(file);
-    if (image.isValid())
+    return loadImage(juce::ImageFileFormat::loadFrom(file));
+}
+
+bool ImageScanner::loadImage(const juce::Image& image)
+{
+    if (!image.isValid())
+        return false;
+
+    currentImage = image;
+    buildPlanes();
+    buildMipPyramid();
+    buildSummedAreaTables();
+    analyzeImage();
+    return true;
+}
+
+void ImageScanner::clearImage()
+{
+    currentImage = {};
+    planeWidth = planeHeight = planeStride = 0;
+    for (auto* plane : { &luminance, &red, &green, &blue })
+        plane->allocate(0);
+    for (auto& level : mipStorage)
+        level.allocate(0);
+    numMipLevels = 0;
+    for (auto* tables : { &areaSums, &areaSquares })
+        for (auto& table : *tables)
+            table = {};
+    statsCellsX = statsCellsY = 0;
+
+    avgBrightness = 0.5f;
+    contrast = 0.5f;
+}
+
+void ImageScanner::swap(ImageScanner& other) noexcept
+{
+    // Heap blocks move with their buffers, so the mip level pointers stay valid
+    std::swap(currentImage, other.currentImage);
+    avgBrightness = other.avgBrightness.exchange(avgBrightness.load());
+    contrast = other.contrast.exchange(contrast.load());
+
+    std::swap(luminance, other.luminance);
+    std::swap(red, other.red);
+    std::swap(green, other.green);
+    std::swap(blue, other.blue);
+    std::swap(planeWidth, other.planeWidth);
+    std::swap(planeHeight, other.planeHeight);
+    std::swap(planeStride, other.planeStride);
+
+    std::swap(mipStorage, other.mipStorage);
+    std::swap(mipLevels, other.mipLevels);
+    std::swap(numMipLevels, other.numMipLevels);
+
+    std::swap(areaSums, other.areaSums);
+    std::swap(areaSquares, other.areaSquares);
+    std::swap(statsCellSize, other.statsCellSize);
+    std::swap(statsCellsX, other.statsCellsX);
+    std::swap(statsCellsY, other.statsCellsY);
+}
+
+void ImageScanner::buildPlanes()
+{
+    planeWidth = currentImage.getWidth();
+    planeHeight = currentImage.getHeight();
+    planeStride = (planeWidth + 7) & ~7;
+
+    const auto planeSize = (size_t)planeStride * (size_t)planeHeight;
+    for (auto* plane : { &luminance, &red, &green, &blue })
+        plane->allocate(planeSize); // zeroed, so the row padding stays 0
+
+    const juce::Image::BitmapData pixels(currentImage, juce::Image::BitmapData::readOnly);
+    for (int y = 0; y < planeHeight; ++y)
     {
-        currentImage = image;
-        analyzeImage();
-        return true;
+        const auto offset = (size_t)y * (size_t)planeStride;
+        float* r = red.data() + offset;
+        float* g = green.data() + offset;
+        float* b = blue.data() + offset;
+
+        const uint8_t* line = pixels.getLinePointer(y);
+        switch (pixels.pixelFormat)
+        {
+            case juce::Image::ARGB:          readRow<juce::PixelARGB>(line, pixels.pixelStride, planeWidth, r, g, b); break;
+            case juce::Image::RGB:           readRow<juce::PixelRGB>(line, pixels.pixelStride, planeWidth, r, g, b); break;
+            case juce::Image::SingleChannel: readRow<juce::PixelAlpha>(line, pixels.pixelStride, planeWidth, r, g, b); break;
+            case juce::Image::UnknownFormat:
+            default:                         break;
+        }
+
+        float* l = luminance.data() + offset;
+        juce::FloatVectorOperations::copyWithMultiply(l, r, lumaRed, planeWidth);
+        juce::FloatVectorOperations::addWithMultiply(l, g, lumaGreen, planeWidth);
+        juce::FloatVectorOperations::addWithMultiply(l, b, lumaBlue, planeWidth);
     }
-    return false;
 }
 
-// … other methods unchanged …
+void ImageScanner::buildMipPyramid()
+{
+    mipLevels[0] = { luminance.data(), planeWidth, planeHeight, planeStride };
+    numMipLevels = 1;
 
-juce::Colour ImageScanner::getInterpolatedPixel(float x, float y) const
+    // 2x2 box filter per level: sum row pairs in one vectorised pass, then column
+    // pairs; an odd last row or column is paired with itself
+    std::vector<float> rowPairs;
+    while (numMipLevels < maxMipLevels)
+    {
+        const MipLevel source = mipLevels[(size_t)numMipLevels - 1];
+        if (source.width == 1 && source.height == 1)
+            break;
+
+        const int width = (source.width + 1) / 2;
+        const int height = (source.height + 1) / 2;
+        const int stride = (width + 7) & ~7;
+        auto& storage = mipStorage[(size_t)numMipLevels];
+        storage.allocate((size_t)stride * (size_t)height);
+
+        rowPairs.resize((size_t)source.width);
+        for (int y = 0; y < height; ++y)
+        {
+            const float* upper = source.data + (size_t)(2 * y) * (size_t)source.stride;
+            const float* lower = source.data + (size_t)juce::jmin(2 * y + 1, source.height - 1) * (size_t)source.stride;
+            juce::FloatVectorOperations::add(rowPairs.data(), upper, lower, source.width);
+
+            float* out = storage.data() + (size_t)y * (size_t)stride;
+            for (int x = 0; x < width; ++x)
+                out[x] = 0.25f * (rowPairs[(size_t)(2 * x)] + rowPairs[(size_t)juce::jmin(2 * x + 1, source.width - 1)]);
+        }
+
+        mipLevels[(size_t)numMipLevels++] = { storage.data(), width, height, stride };
+    }
+}
+
+void ImageScanner::buildSummedAreaTables()
 {
-    if (!currentImage.isValid()) return juce::Colours::black;
+    statsCellSize = juce::jmax(1, (juce::jmax(planeWidth, planeHeight) + statsGridSize - 1) / statsGridSize);
+    statsCellsX = (planeWidth + statsCellSize - 1) / statsCellSize;
+    statsCellsY = (planeHeight + statsCellSize - 1) / statsCellSize;
+    const int tableWidth = statsCellsX + 1;
+
+    const std::array<const float*, numChannels> planes { luminance.data(), red.data(), green.data(), blue.data() };
+    std::vector<double> cellSums((size_t)statsCellsX), cellSquares((size_t)statsCellsX);
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto& sums = areaSums[(size_t)c];
+        auto& squares = areaSquares[(size_t)c];
+        sums.assign((size_t)(tableWidth * (statsCellsY + 1)), 0.0);
+        squares.assign(sums.size(), 0.0);
+
+        for (int cy = 0; cy < statsCellsY; ++cy)
+        {
+            // Per-cell totals over this band of pixel rows
+            std::fill(cellSums.begin(), cellSums.end(), 0.0);
+            std::fill(cellSquares.begin(), cellSquares.end(), 0.0);
+            const int lastRow = juce::jmin((cy + 1) * statsCellSize, planeHeight);
+            for (int y = cy * statsCellSize; y < lastRow; ++y)
+            {
+                const float* row = planes[(size_t)c] + (size_t)y * (size_t)planeStride;
+                for (int cx = 0, x = 0; cx < statsCellsX; ++cx)
+                {
+                    // A cell row is at most a few dozen pixels: float is exact enough here
+                    float sum = 0.0f, sumSquares = 0.0f;
+                    for (const int end = juce::jmin(x + statsCellSize, planeWidth); x < end; ++x)
+                    {
+                        sum += row[x];
+                        sumSquares += row[x] * row[x];
+                    }
+                    cellSums[(size_t)cx] += sum;
+                    cellSquares[(size_t)cx] += sumSquares;
+                }
+            }
 
-    const float xPos = juce::jlimit(0.0f, 1.0f, x);
-    const float yPos = juce::jlimit(0.0f, 1.0f, y);
+            // Table row cy + 1 = row cy plus the running totals along this band
+            double runningSum = 0.0, runningSquares = 0.0;
+            const auto above = (size_t)(cy * tableWidth), here = above + (size_t)tableWidth;
+            for (int cx = 0; cx < statsCellsX; ++cx)
+            {
+                runningSum += cellSums[(size_t)cx];
+                runningSquares += cellSquares[(size_t)cx];
+                sums[here + (size_t)cx + 1] = sums[above + (size_t)cx + 1] + runningSum;
+                squares[here + (size_t)cx + 1] = squares[above + (size_t)cx + 1] + runningSquares;
+            }
+        }
+    }
+}
 
-    const float fX = xPos * (currentImage.getWidth() - 1);
-    const float fY = yPos * (currentImage.getHeight() - 1);
+ImageScanner::RegionStats ImageScanner::getRegionStats(juce::Rectangle<float> area, Channel channel) const
+{
+    if (!hasImage())
+        return {};
 
-    const int x0 = static_cast<int>(fX);
-    const int y0 = static_cast<int>(fY);
-    const int x1 = std::min(x0 + 1, currentImage.getWidth() - 1);
-    const int y1 = std::min(y0 + 1, currentImage.getHeight() - 1);
+    // Pixel edges of the area, widened about its centre to at least one pixel
+    const auto pixelSpan = [](float start, float end, int size)
+    {
+        float first = juce::jlimit(0.0f, (float)size, start * (float)size);
+        float last = juce::jlimit(0.0f, (float)size, end * (float)size);
+        if (last - first < 1.0f)
+        {
+            const float centre = juce::jlimit(0.5f, (float)size - 0.5f, 0.5f * (first + last));
+            first = centre - 0.5f;
+            last = centre + 0.5f;
+        }
+        return std::make_pair(first, last);
+    };
 
-    const float fx = fX - x0;
-    const float fy = fY - y0;
+    // Pixel position -> table position; the last cell may be narrower than the rest
+    const auto toTable = [this](float pixel, int numCells, int size)
+    {
+        const int cell = juce::jmin((int)pixel / statsCellSize, numCells - 1);
+        const int start = cell * statsCellSize;
+        return (double)cell + (double)(pixel - (float)start) / (double)(juce::jmin(start + statsCellSize, size) - start);
+    };
 
-    auto p00 = currentImage.getPixelAt(x0, y0);
-    auto p10 = currentImage.getPixelAt(x1, y0);
-    auto p01 = currentImage.getPixelAt(x0, y1);
-    auto p11 = currentImage.getPixelAt(x1, y1);
+    const auto [px0, px1] = pixelSpan(area.getX(), area.getRight(), planeWidth);
+    const auto [py0, py1] = pixelSpan(area.getY(), area.getBottom(), planeHeight);
+    const double u0 = toTable(px0, statsCellsX, planeWidth), u1 = toTable(px1, statsCellsX, planeWidth);
+    const double v0 = toTable(py0, statsCellsY, planeHeight), v1 = toTable(py1, statsCellsY, planeHeight);
 
-    auto lerp = [](const juce::Colour& a, const juce::Colour& b, float t)
+    // Bilinear reads of a summed-area table are exact for pixels evenly spread in each cell
+    const int tableWidth = statsCellsX + 1;
+    const auto sumTo = [&](const std::vector<double>& table, double u, double v)
     {
-        return juce::Colour(
-            static_cast<uint8_t>((1.0f - t) * a.getRed()   + t * b.getRed()),
-            static_cast<uint8_t>((1.0f - t) * a.getGreen() + t * b.getGreen()),
-            static_cast<uint8_t>((1.0f - t) * a.getBlue()  + t * b.getBlue()),
-            static_cast<uint8_t>((1.0f - t) * a.getAlpha() + t * b.getAlpha())
-        );
+        const int i = juce::jmin((int)u, statsCellsX - 1), j = juce::jmin((int)v, statsCellsY - 1);
+        const double fu = u - (double)i, fv = v - (double)j;
+        const double* above = table.data() + (size_t)(j * tableWidth + i);
+        const double* below = above + tableWidth;
+        return (1.0 - fv) * (above[0] + fu * (above[1] - above[0]))
+             + fv * (below[0] + fu * (below[1] - below[0]));
     };
+    const auto total = [&](const std::vector<double>& table)
+    {
+        return sumTo(table, u1, v1) - sumTo(table, u0, v1) - sumTo(table, u1, v0) + sumTo(table, u0, v0);
+    };
+
+    const double count = (double)(px1 - px0) * (double)(py1 - py0);
+    const auto c = (size_t)channel;
+    const double mean = total(areaSums[c]) / count;
+    const double variance = juce::jmax(0.0, total(areaSquares[c]) / count - mean * mean);
+
+    RegionStats stats;
+    stats.mean = (float)mean;
+    stats.variance = (float)variance;
+    stats.contrast = juce::jlimit(0.0f, 1.0f, 2.0f * (float)std::sqrt(variance));
+    return stats;
+}
+
+float ImageScanner::samplePlane(const float* plane, float x, float y) const noexcept
+{
+    const float fX = juce::jlimit(0.0f, 1.0f, x) * (float)(planeWidth - 1);
+    const float fY = juce::jlimit(0.0f, 1.0f, y) * (float)(planeHeight - 1);
+
+    const int x0 = (int)fX;
+    const int y0 = (int)fY;
+    const int x1 = juce::jmin(x0 + 1, planeWidth - 1);
+    const int y1 = juce::jmin(y0 + 1, planeHeight - 1);
+    const float fx = fX - (float)x0;
+    const float fy = fY - (float)y0;
+
+    const float* row0 = plane + (size_t)y0 * (size_t)planeStride;
+    const float* row1 = plane + (size_t)y1 * (size_t)planeStride;
+    const float top = row0[x0] + fx * (row0[x1] - row0[x0]);
+    const float bottom = row1[x0] + fx * (row1[x1] - row1[x0]);
+    return top + fy * (bottom - top);
+}
+
+float ImageScanner::getPixelBrightness(float x, float y) const
+{
+    return hasImage() ? samplePlane(luminance.data(), x, y) : 0.0f;
+}
+
+juce::Colour ImageScanner::getPixelColour(float x, float y) const
+{
+    return getInterpolatedPixel(x, y);
+}
+
+juce::Colour ImageScanner::getInterpolatedPixel(float x, float y) const
+{
+    if (!hasImage())
+        return juce::Colours::black;
+
+    return juce::Colour::fromFloatRGBA(samplePlane(red.data(), x, y),
+                                       samplePlane(green.data(), x, y),
+                                       samplePlane(blue.data(), x, y),
+                                       1.0f);
+}
+
+std::vector<float> ImageScanner::getScanLine(float y, int numSamples) const
+{
+    return extractLine(true, y, numSamples);
+}
+
+std::vector<float> ImageScanner::getVerticalScanLine(float x, int numSamples) const
+{
+    return extractLine(false, x, numSamples);
+}
+
+std::vector<float> ImageScanner::extractLine(bool horizontal, float position, int numSamples) const
+{
+    std::vector<float> line((size_t)juce::jmax(0, numSamples), 0.0f);
+    if (!hasImage() || numSamples <= 0)
+        return line;
+
+    // Trilinear: the two levels around one output sample per pixel, blended
+    const int fullLength = horizontal ? planeWidth : planeHeight;
+    const float lod = juce::jlimit(0.0f, (float)(numMipLevels - 1), std::log2((float)fullLength / (float)numSamples));
+    const int level = (int)lod;
+    const float blend = lod - (float)level;
+
+    extractFromLevel(level, horizontal, position, numSamples, line.data());
+    if (blend > 0.0f && level + 1 < numMipLevels)
+    {
+        std::vector<float> coarser((size_t)numSamples);
+        extractFromLevel(level + 1, horizontal, position, numSamples, coarser.data());
+        juce::FloatVectorOperations::multiply(line.data(), 1.0f - blend, numSamples);
+        juce::FloatVectorOperations::addWithMultiply(line.data(), coarser.data(), blend, numSamples);
+    }
+    return line;
+}
+
+void ImageScanner::extractFromLevel(int level, bool horizontal, float position, int numSamples, float* out) const
+{
+    const MipLevel& mip = mipLevels[(size_t)level];
+    const int along = horizontal ? mip.width : mip.height;
+    const int across = horizontal ? mip.height : mip.width;
+    const int fullAlong = horizontal ? planeWidth : planeHeight;
+    const int fullAcross = horizontal ? planeHeight : planeWidth;
+
+    // Level-0 pixel u sits at (u + 0.5) / 2^level - 0.5 on this level
+    const float scale = 1.0f / (float)(1 << level);
+    const float acrossPosition = juce::jlimit(0.0f, (float)(across - 1),
+                                              (juce::jlimit(0.0f, 1.0f, position) * (float)(fullAcross - 1) + 0.5f) * scale - 0.5f);
+    const int a0 = (int)acrossPosition;
+    const int a1 = juce::jmin(a0 + 1, across - 1);
+    const float fa = acrossPosition - (float)a0;
+
+    // Blend the two bracketing rows (one vectorised pass) or columns into one line
+    AlignedFloatBuffer line((size_t)along);
+    if (horizontal)
+    {
+        juce::FloatVectorOperations::copyWithMultiply(line.data(), mip.data + (size_t)a0 * (size_t)mip.stride, 1.0f - fa, along);
+        juce::FloatVectorOperations::addWithMultiply(line.data(), mip.data + (size_t)a1 * (size_t)mip.stride, fa, along);
+    }
+    else
+    {
+        const float* row = mip.data;
+        for (int r = 0; r < along; ++r, row += mip.stride)
+            line[(size_t)r] = row[a0] + fa * (row[a1] - row[a0]);
+    }
+
+    // Output samples spread end to end over the level-0 line
+    const float step = numSamples > 1 ? (float)(fullAlong - 1) / (float)(numSamples - 1) * scale : 0.0f;
+    resample(line.data(), along, out, numSamples, 0.5f * scale - 0.5f, step);
+}
+
+void ImageScanner::analyzeImage()
+{
+    if (!hasImage())
+        return;
 
-    auto px0 = lerp(p00, p10, fx);
-    auto px1 = lerp(p01, p11, fx);
-    return lerp(px0, px1, fy);
+    // Whole-image luminance; contrast is twice the RMS deviation from the mean
+    // (1 for an image that is half black, half white)
+    const auto stats = getRegionStats({ 0.0f, 0.0f, 1.0f, 1.0f });
+    avgBrightness = stats.mean;
+    contrast = stats.contrast;
 }
@@ -1,6 +1,8 @@
 // source/plugin/ImageScanner.h
 #pragma once
 #include <juce_graphics/juce_graphics.h>
+#include "../core/AlignedBuffer.h"
+#include <array>
 #include <atomic>
 #include <vector>
 
@@ -15,6 +17,10 @@ public:
     bool loadImage(const juce::Image& image);
     void clearImage();
     
+    // Exchanges everything with another scanner, e.g. one loaded on a background
+    // thread (see ImageLoader); no pixel data is copied
+    void swap(ImageScanner& other) noexcept;
+    
     // Image data access
     const juce::Image& getImage() const { return currentImage; }
     bool hasImage() const { return currentImage.isValid(); }
@@ -23,7 +29,9 @@ public:
     float getPixelBrightness(float x, float y) const;  // x,y in 0-1 range
     juce::Colour getPixelColour(float x, float y) const;
     
-    // Get scan line data for spectral processing
+    // Get scan line data for spectral processing. Lines shorter than the image
+    // are read from the matching level of a luminance mip pyramid (trilinear),
+    // so each output sample averages the pixels it covers.
     std::vector<float> getScanLine(float y, int numSamples) const;
     std::vector<float> getVerticalScanLine(float x, int numSamples) const;
     
@@ -32,15 +40,79 @@ public:
     float getAverageBrightness() const { return avgBrightness; }
     float getContrast() const { return contrast; }
     
+    // Region statistics in constant time, from summed-area tables of each channel
+    // and its square built at load time. The tables work on a grid of at most
+    // statsGridSize cells per side (cells of up to 32 pixels on a 16K image).
+    // The area (0..1 image coordinates, at least one pixel across) is used as
+    // given: inside the cells its edges cut, pixels are taken as evenly spread.
+    // Areas on cell boundaries are exact; otherwise only pixels within one cell
+    // of the edges are estimated, so for an area w x h pixels the mean is off by
+    // at most (2 / w + 2 / h) * cellSize of the value range, and in practice far
+    // less.
+    enum class Channel { Luminance, Red, Green, Blue };
+    struct RegionStats
+    {
+        float mean = 0.0f;
+        float variance = 0.0f;
+        float contrast = 0.0f;   // 2 * standard deviation, clipped to 1
+    };
+    RegionStats getRegionStats(juce::Rectangle<float> area, Channel channel = Channel::Luminance) const;
+    int getStatsCellSize() const { return statsCellSize; }
+    
     // Image dimensions
     int getWidth() const { return currentImage.getWidth(); }
     int getHeight() const { return currentImage.getHeight(); }
     
+    // Planar float copies of the image (0..1, composited over black), built at
+    // load time so lookups and scan lines never go through juce::Image. Rows
+    // are getPlaneStride() floats apart, padded to a multiple of 8 and 32-byte aligned.
+    const float* getLuminancePlane() const { return luminance.data(); }
+    const float* getRedPlane() const { return red.data(); }
+    const float* getGreenPlane() const { return green.data(); }
+    const float* getBluePlane() const { return blue.data(); }
+    int getPlaneStride() const { return planeStride; }
+    
 private:
     juce::Image currentImage;
     std::atomic<float> avgBrightness{0.5f};
     std::atomic<float> contrast{0.5f};
     
+    AlignedFloatBuffer luminance, red, green, blue;
+    int planeWidth = 0;
+    int planeHeight = 0;
+    int planeStride = 0;
+    
+    // Luminance mip pyramid: level 0 is the luminance plane, each level above
+    // halves both dimensions with a 2x2 box filter
+    static constexpr int maxMipLevels = 16;
+    struct MipLevel
+    {
+        const float* data = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+    };
+    std::array<AlignedFloatBuffer, maxMipLevels> mipStorage;   // levels 1 and up
+    std::array<MipLevel, maxMipLevels> mipLevels;
+    int numMipLevels = 0;
+    
+    // Summed-area tables, (statsCellsX + 1) x (statsCellsY + 1) per channel, each
+    // cell summing a statsCellSize square of pixels
+    static constexpr int statsGridSize = 512;
+    static constexpr int numChannels = 4;
+    std::array<std::vector<double>, numChannels> areaSums;
+    std::array<std::vector<double>, numChannels> areaSquares;
+    int statsCellSize = 1;
+    int statsCellsX = 0;
+    int statsCellsY = 0;
+    
+    void buildPlanes();
+    void buildMipPyramid();
+    void buildSummedAreaTables();
+    float samplePlane(const float* plane, float x, float y) const noexcept;
+    std::vector<float> extractLine(bool horizontal, float position, int numSamples) const;
+    void extractFromLevel(int level, bool horizontal, float position, int numSamples, float* out) const;
+    
     // Helper to get interpolated pixel value
     juce::Colour getInterpolatedPixel(float x, float y) const;
     
@@ -13,11 +13,31 @@ ArtefactAudioProcessorEditor::ArtefactAudioProcessorEditor (ArtefactAudioProcess
     canvas = std::make_unique<juce::ImageComponent>("Canvas");
     auto canvasImage = juce::ImageFileFormat::loadFrom(BinaryData::The_Grid_jpeg, BinaryData::The_Grid_jpegSize);
     if (canvasImage.isValid())
+    {
         canvas->setImage(canvasImage, juce::RectanglePlacement::stretchToFit);
+        ImageScanner scanner;
+        if (scanner.loadImage(canvasImage))
+            processorRef.setConvolutionImage(scanner);
+    }
     addAndMakeVisible(*canvas);
 
+    // Dropped images: the preview is shown as soon as it is decoded, the impulse
+    // response follows once the scanner's tables are built
+    imageLoader.onPreview = [this](const juce::Image& preview, int, int)
+    {
+        canvas->setImage(preview, juce::RectanglePlacement::stretchToFit);
+    };
+    imageLoader.onScanner = [this](std::unique_ptr<ImageScanner> scanner, const juce::File&)
+    {
+        processorRef.setConvolutionImage(*scanner);
+    };
+
+    // --- SPECTROGRAM ---
+    spectrogram = std::make_unique<SpectrogramComponent>(processorRef.getSpectralEngine().getSpectrumTap());
+    addAndMakeVisible(*spectrogram);
+
     // --- SAMPLER SLOTS ---
-    for (int i = 0; i < 8; ++i)
+    for (int i = 0; i < ArtefactAudioProcessor::numSampleSlots; ++i)
     {
         auto slotButton = std::make_unique<juce::TextButton>("[SLOT " + juce::String(i + 1) + "]");
         slotButton->setClickingTogglesState(true);
@@ -25,10 +45,16 @@ ArtefactAudioProcessorEditor::ArtefactAudioProcessorEditor (ArtefactAudioProcess
         slotButton->setColour(juce::TextButton::textColourOnId, juce::Colours::yellow);
         slotButton->setColour(juce::TextButton::buttonOnColourId, juce::Colour(0xff2a2a2a));
         slotButton->setColour(juce::TextButton::buttonColourId, juce::Colour(0xff2a2a2a));
+        slotButton->onClick = [this, i] { processorRef.selectSampleSlot(i); };
         addAndMakeVisible(*slotButton);
         samplerSlots.add(std::move(slotButton));
     }
-    samplerSlots[0]->setToggleState(true, juce::dontSendNotification);
+    samplerSlots[processorRef.getSelectedSampleSlot()]->setToggleState(true, juce::dontSendNotification);
+
+    // --- MODE ---
+    modeBox = std::make_unique<juce::ComboBox>("Mode");
+    modeBox->addItemList(processorRef.apvts.getParameter("MODE")->getAllValueStrings(), 1);
+    addAndMakeVisible(*modeBox);
 
     // --- KNOBS ---
     auto createKnob = [&](std::unique_ptr<juce::Slider>& knob, const juce::String& text)
@@ -60,6 +86,7 @@ ArtefactAudioProcessorEditor::ArtefactAudioProcessorEditor (ArtefactAudioProcess
     crushAttachment = std::make_unique<SliderAttachment>(processorRef.apvts, "CRUSH", *crushKnob);
     filterAttachment = std::make_unique<SliderAttachment>(processorRef.apvts, "FILTER", *filterKnob);
     jitterAttachment = std::make_unique<SliderAttachment>(processorRef.apvts, "JITTER", *jitterKnob);
+    modeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(processorRef.apvts, "MODE", *modeBox);
 
     setSize (800, 600);
 }
@@ -97,7 +124,8 @@ void ArtefactAudioProcessorEditor::resized()
     // Left Column
     juce::FlexBox canvasBox;
     canvasBox.flexDirection = juce::FlexBox::Direction::column;
-    canvasBox.items.add(juce::FlexItem(*canvas).withFlex(1.0f)); // Canvas takes all vertical space
+    canvasBox.items.add(juce::FlexItem(*canvas).withFlex(1.0f)); // Canvas takes most of the vertical space
+    canvasBox.items.add(juce::FlexItem(*spectrogram).withFlex(0.3f).withMargin(juce::FlexItem::Margin(10,0,0,0)));
     mainBox.items.add(juce::FlexItem(canvasBox).withFlex(0.65f)); // Canvas box takes 65% of width
 
     // Right Column
@@ -125,10 +153,43 @@ void ArtefactAudioProcessorEditor::resized()
     knobBox.items.add(createKnobItem(*filterKnob, *filterLabel));
     knobBox.items.add(createKnobItem(*jitterKnob, *jitterLabel));
 
+    rightColumnBox.items.add(juce::FlexItem(*modeBox).withHeight(24.0f).withMargin(juce::FlexItem::Margin(0,0,10,0)));
     rightColumnBox.items.add(juce::FlexItem(slotBox).withFlex(0.6f));
     rightColumnBox.items.add(juce::FlexItem(knobBox).withFlex(0.4f).withMargin(juce::FlexItem::Margin(10,0,0,0)));
 
     mainBox.items.add(juce::FlexItem(rightColumnBox).withFlex(0.35f).withMargin(juce::FlexItem::Margin(0,0,0,10)));
 
     mainBox.performLayout(bounds);
+}
+
+bool ArtefactAudioProcessorEditor::isInterestedInFileDragging(const juce::StringArray& files)
+{
+    for (const auto& path : files)
+    {
+        const juce::File file(path);
+        if (juce::ImageFileFormat::findImageFormatForFileExtension(file) != nullptr
+            || file.hasFileExtension("wav;aif;aiff;flac;ogg;mp3"))
+            return true;
+    }
+    return false;
+}
+
+void ArtefactAudioProcessorEditor::filesDropped(const juce::StringArray& files, int x, int y)
+{
+    juce::ignoreUnused(x, y);
+
+    for (const auto& path : files)
+    {
+        const juce::File file(path);
+        if (juce::ImageFileFormat::findImageFormatForFileExtension(file) != nullptr)
+        {
+            imageLoader.load(file);
+        }
+        else
+        {
+            const int slot = processorRef.getSelectedSampleSlot();
+            if (processorRef.loadSampleSlot(slot, file))
+                samplerSlots[slot]->setButtonText("[" + file.getFileNameWithoutExtension().toUpperCase() + "]");
+        }
+    }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 #include "PluginProcessor.h"
+#include "../ui/SpectrogramComponent.h"
+#include "ImageLoader.h"
 
 // A custom LookAndFeel class to get the exact "Null-OS" style
 class ArtefactLookAndFeel : public juce::LookAndFeel_V4
@@ -32,7 +34,8 @@ public:
     }
 };
 
-class ArtefactAudioProcessorEditor  : public juce::AudioProcessorEditor
+class ArtefactAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                      public juce::FileDragAndDropTarget
 {
 public:
     explicit ArtefactAudioProcessorEditor (ArtefactAudioProcessor&);
@@ -41,12 +44,20 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    // Images replace the canvas (and the image impulse response); audio files
+    // load into the selected sample slot
+    bool isInterestedInFileDragging (const juce::StringArray& files) override;
+    void filesDropped (const juce::StringArray& files, int x, int y) override;
+
 private:
     ArtefactAudioProcessor& processorRef;
 
     // --- OUR UI COMPONENTS ---
     std::unique_ptr<juce::ImageComponent> canvas;
+    std::unique_ptr<SpectrogramComponent> spectrogram;
     juce::Array<std::unique_ptr<juce::TextButton>> samplerSlots;
+    std::unique_ptr<juce::ComboBox> modeBox;
+    ImageLoader imageLoader;    // decodes dropped images off the message thread
     
     std::unique_ptr<juce::Slider> driveKnob, crushKnob, filterKnob, jitterKnob;
     std::unique_ptr<juce::Label> driveLabel, crushLabel, filterLabel, jitterLabel;
@@ -54,6 +65,7 @@ private:
     // This object links our sliders to the processor parameters
     using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
     std::unique_ptr<SliderAttachment> driveAttachment, crushAttachment, filterAttachment, jitterAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> modeAttachment;
 
     juce::Font pixelFont;
     ArtefactLookAndFeel lookAndFeel;
@@ -2,9 +2,11 @@
 #include "PluginEditor.h"
 
 ArtefactAudioProcessor::ArtefactAudioProcessor()
-     : AudioProcessor (BusesProperties().withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
+     : AudioProcessor (BusesProperties().withInput ("Input", juce::AudioChannelSet::stereo(), true)
+                                         .withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
        apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
+    modeParameter = apvts.getRawParameterValue ("MODE");
 }
 
 ArtefactAudioProcessor::~ArtefactAudioProcessor() {}
@@ -18,8 +20,21 @@ int ArtefactAudioProcessor::getCurrentProgram() { return 0; }
 void ArtefactAudioProcessor::setCurrentProgram (int index) { juce::ignoreUnused (index); }
 const juce::String ArtefactAudioProcessor::getProgramName (int index) { juce::ignoreUnused (index); return {}; }
 void ArtefactAudioProcessor::changeProgramName (int index, const juce::String& newName) { juce::ignoreUnused (index, newName); }
-void ArtefactAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock) {}
-void ArtefactAudioProcessor::releaseResources() {}
+void ArtefactAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    sampleManager.prepareToPlay (sampleRate, samplesPerBlock);
+    spectralEngine.prepareToPlay (sampleRate, samplesPerBlock);
+    granularEngine.prepare (sampleRate, samplesPerBlock);
+    percussiveBuffer.setSize (1, samplesPerBlock);
+    grainBuffer.setSize (2, samplesPerBlock);
+    pendingLatency.store (spectralEngine.getLatencySamples());
+    setLatencySamples (pendingLatency.load());
+}
+
+void ArtefactAudioProcessor::releaseResources()
+{
+    spectralEngine.releaseResources();
+}
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool ArtefactAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -27,13 +42,136 @@ bool ArtefactAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
      && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
         return false;
-    return true;
+    return layouts.getMainInputChannelSet() == layouts.getMainOutputChannelSet();
 }
 #endif
 
-void ArtefactAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiMessages& midiMessages)
+void ArtefactAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+
+    const int mode = (int) modeParameter->load();
+    if (mode != activeMode)
+    {
+        activeMode = mode;
+        spectralEngine.setMode ((SpectralEngine::ProcessingMode) mode);
+    }
+
+    // The engine is mono: the input channels are summed into the first one,
+    // processed in place and copied back out to every channel
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+    if (numChannels == 0)
+        return;
+
+    float* mono = buffer.getWritePointer (0);
+    for (int ch = 1; ch < numChannels; ++ch)
+        buffer.addFrom (0, 0, buffer, ch, 0, numSamples);
+    if (numChannels > 1)
+        juce::FloatVectorOperations::multiply (mono, 1.0f / (float) numChannels, numSamples);
+
+    if (activeMode == (int) SpectralEngine::ProcessingMode::HarmonicPercussive)
+    {
+        processHarmonicPercussive (buffer);
+    }
+    else
+    {
+        spectralEngine.process (mono, mono, numSamples);
+
+        for (int ch = 1; ch < numChannels; ++ch)
+            buffer.copyFrom (ch, 0, buffer, 0, 0, numSamples);
+    }
+
+    // Frame size and mode can change at runtime; the host is told on the message thread
+    const int latency = spectralEngine.getLatencySamples();
+    if (latency != pendingLatency.exchange (latency))
+        triggerAsyncUpdate();
+}
+
+void ArtefactAudioProcessor::processHarmonicPercussive (juce::AudioBuffer<float>& buffer)
+{
+    // Expects the mono mix in channel 0. Runs in chunks of the prepared block
+    // size, since hosts may pass larger blocks than they announced.
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+    const int chunkSize = percussiveBuffer.getNumSamples();
+    if (chunkSize == 0)
+        return;
+
+    float* mono = buffer.getWritePointer (0);
+    float* percussive = percussiveBuffer.getWritePointer (0);
+
+    for (int offset = 0; offset < numSamples; offset += chunkSize)
+    {
+        const int n = juce::jmin (chunkSize, numSamples - offset);
+
+        spectralEngine.process (mono + offset, mono + offset, percussive, n);
+        granularEngine.writeSource (percussive, n);
+
+        // Refers to grainBuffer's channels; no allocation
+        juce::AudioBuffer<float> grains (grainBuffer.getArrayOfWritePointers(), 2, n);
+        granularEngine.process (grains);
+
+        for (int ch = 1; ch < numChannels; ++ch)
+            buffer.copyFrom (ch, offset, buffer, 0, offset, n);
+
+        if (numChannels == 1)
+        {
+            buffer.addFrom (0, offset, grains, 0, 0, n, 0.5f);
+            buffer.addFrom (0, offset, grains, 1, 0, n, 0.5f);
+        }
+        else
+        {
+            buffer.addFrom (0, offset, grains, 0, 0, n);
+            buffer.addFrom (1, offset, grains, 1, 0, n);
+        }
+    }
+}
+
+void ArtefactAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples (pendingLatency.load());
+}
+
+bool ArtefactAudioProcessor::loadSampleSlot (int slot, const juce::File& file)
+{
+    if (slot < 0 || slot >= numSampleSlots || ! sampleManager.loadSample (slot, file))
+        return false;
+
+    if (slot == selectedSlot)
+        applySelectedImpulse();
+    return true;
+}
+
+void ArtefactAudioProcessor::selectSampleSlot (int slot)
+{
+    selectedSlot = juce::jlimit (0, numSampleSlots - 1, slot);
+    applySelectedImpulse();
+}
+
+void ArtefactAudioProcessor::setConvolutionImage (const ImageScanner& image)
+{
+    if (! image.hasImage())
+        return;
+
+    // One magnitude per band of rows (at most 512), each averaged over the whole width
+    const int rows = juce::jmin (image.getHeight(), 512);
+    const float band = 1.0f / (float) rows;
+    imageSpectrum.assign ((size_t) rows, 0.0f);
+
+    for (int r = 0; r < rows; ++r)
+        imageSpectrum[(size_t) r] = image.getRegionStats ({ 0.0f, 1.0f - (float) (r + 1) * band, 1.0f, band }).mean;
+
+    if (! sampleManager.isSampleLoaded (selectedSlot))
+        applySelectedImpulse();
+}
+
+void ArtefactAudioProcessor::applySelectedImpulse()
 {
-    buffer.clear();
+    if (sampleManager.isSampleLoaded (selectedSlot))
+        spectralEngine.loadImpulseResponse (sampleManager, selectedSlot);
+    else if (! imageSpectrum.empty())
+        spectralEngine.setConvolutionSpectrum (imageSpectrum);
 }
 
 bool ArtefactAudioProcessor::hasEditor() const { return true; }
@@ -65,6 +203,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout ArtefactAudioProcessor::crea
     layout.add(std::make_unique<juce::AudioParameterFloat>("CRUSH", "Crush", 0.0f, 1.0f, 0.0f));
     layout.add(std::make_unique<juce::AudioParameterFloat>("FILTER", "Filter", 0.0f, 1.0f, 1.0f));
     layout.add(std::make_unique<juce::AudioParameterFloat>("JITTER", "Jitter", 0.0f, 1.0f, 0.0f));
+    // Choices in SpectralEngine::ProcessingMode order
+    layout.add(std::make_unique<juce::AudioParameterChoice>("MODE", "Mode",
+        juce::StringArray { "Bypass", "Frequency Mask", "Spectral Blur", "Spectral Freeze", "Convolution",
+                            "Low-Latency Mask", "Additive", "Cross Synthesis", "Harmonic/Percussive" }, 0));
 
     return layout;
 }
@@ -1,7 +1,13 @@
 #pragma once
 #include <JuceHeader.h>
+#include "../engine/SpectralEngine.h"
+#include "../engine/SampleManager.h"
+#include "../dsp/granular/GranularEngine.h"
+#include "ImageScanner.h"
+#include <vector>
 
-class ArtefactAudioProcessor  : public juce::AudioProcessor
+class ArtefactAudioProcessor  : public juce::AudioProcessor,
+                                private juce::AsyncUpdater
 {
 public:
     ArtefactAudioProcessor();
@@ -10,7 +16,7 @@ public:
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     bool isBusesLayoutSupported (const juce::BusesLayout& layouts) const override;
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiMessages&) override;
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -30,6 +36,41 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    SpectralEngine& getSpectralEngine() noexcept { return spectralEngine; }
+
+    // Sample slots (message thread). The selected slot is the convolution impulse
+    // response; while it is empty, the response comes from the last image given
+    // to setConvolutionImage (rows averaged across the width, bottom row = DC).
+    // The rows are read from the scanner's summed-area tables, so this is cheap
+    // whatever the image size; pass the scanner ImageLoader delivers.
+    static constexpr int numSampleSlots = 8;
+    bool loadSampleSlot (int slot, const juce::File& file);
+    void selectSampleSlot (int slot);
+    int getSelectedSampleSlot() const noexcept { return selectedSlot; }
+    void setConvolutionImage (const ImageScanner& image);
+
+    juce::AudioProcessorValueTreeState apvts;
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
 private:
+    void applySelectedImpulse();
+    void processHarmonicPercussive (juce::AudioBuffer<float>& buffer);
+    void handleAsyncUpdate() override;
+
+    SpectralEngine spectralEngine;
+    SampleManager sampleManager;
+    int selectedSlot = 0;
+    std::vector<float> imageSpectrum;   // magnitudes from setConvolutionImage
+
+    // Harmonic/Percussive mode: the percussive part is the live source of the
+    // grain cloud, whose output is mixed back in with the harmonic part
+    GranularEngine granularEngine;
+    juce::AudioBuffer<float> percussiveBuffer;  // mono, one block, sized in prepareToPlay
+    juce::AudioBuffer<float> grainBuffer;       // stereo, one block, sized in prepareToPlay
+
+    std::atomic<float>* modeParameter = nullptr;
+    int activeMode = -1;                // audio thread
+    std::atomic<int> pendingLatency { 0 };  // engine latency seen by the audio thread
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ArtefactAudioProcessor)
 };
\ No newline at end of file
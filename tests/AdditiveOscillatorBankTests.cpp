@@ -0,0 +1,55 @@
+// tests/AdditiveOscillatorBankTests.cpp
+#include "../engine/AdditiveOscillatorBank.h"
+#include "TestUtils.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+
+    float peak(const std::vector<float>& x)
+    {
+        float p = 0.0f;
+        for (float v : x)
+            p = std::max(p, std::abs(v));
+        return p;
+    }
+}
+
+int main()
+{
+    AdditiveOscillatorBank bank;
+    bank.prepare(sampleRate);
+
+    std::vector<float> column(64, 0.5f), out((size_t)blockSize);
+    for (int i = 0; i < 8; ++i)
+        bank.render(column.data(), (int)column.size(), out.data(), blockSize);
+    test::check(peak(out) > 0.1f, "a column sounds (peak)", peak(out));
+
+    // No column arrives (e.g. while a background frame holds the field): the
+    // partials fade out within a block, whether or not the range just changed
+    for (bool retune : { false, true })
+    {
+        for (int i = 0; i < 8; ++i)
+            bank.render(column.data(), (int)column.size(), out.data(), blockSize);
+        if (retune)
+            bank.setFrequencyRange(50.0f, 8000.0f);
+
+        bank.render(nullptr, 0, out.data(), blockSize);
+        const float fading = peak(out);
+        test::check(std::isfinite(fading) && fading < 1.0f, "the fade-out block stays bounded (peak)", fading);
+        bank.render(nullptr, 0, out.data(), blockSize);
+        test::check(peak(out) == 0.0f, retune ? "silent after a retune with no column (peak)"
+                                              : "silent with no column (peak)", peak(out));
+        test::check(bank.getActivePartials() == 0, "no partials left active (count)", bank.getActivePartials());
+    }
+
+    // The new range applies with the next column
+    for (int i = 0; i < 8; ++i)
+        bank.render(column.data(), (int)column.size(), out.data(), blockSize);
+    test::check(peak(out) > 0.1f, "the retuned bank sounds again (peak)", peak(out));
+
+    return test::failures;
+}
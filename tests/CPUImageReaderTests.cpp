@@ -0,0 +1,73 @@
+// tests/CPUImageReaderTests.cpp
+#include "../gpu/CPUImageReader.h"
+#include "TestUtils.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Runs one analysis on the calling thread instead of the reader's own
+    struct DirectReader : CPUImageReader
+    {
+        using CPUImageReader::CPUImageReader;
+        void analyze(ImageModData& data) { analyzeFrame(data); }
+    };
+
+    float largestDifference(const ImageModData& a, const ImageModData& b)
+    {
+        float difference = std::max({ std::abs(a.brightness - b.brightness), std::abs(a.centerR - b.centerR),
+                                      std::abs(a.centerG - b.centerG), std::abs(a.centerB - b.centerB) });
+        for (size_t i = 0; i < a.densityCurve.size(); ++i)
+            difference = std::max(difference, std::abs(a.densityCurve[i] - b.densityCurve[i]));
+        return difference;
+    }
+}
+
+int main()
+{
+    // The pool must match the per-pixel reference whatever the frame shape and
+    // however the rows are split, including strips narrower than a column and
+    // rows padded past the last pixel
+    std::mt19937 random(1);
+    for (int threads : { 1, 3, 8 })
+    {
+        DirectReader reader(threads);
+        float worst = 0.0f;
+        for (int width : { 1, 5, 16, 17, 640, 1920 })
+            for (int height : { 1, 3, 480 })
+            {
+                const size_t rowBytes = (size_t)width * 4 + 12;
+                std::vector<uint8_t> pixels(rowBytes * (size_t)height);
+                for (auto& p : pixels)
+                    p = (uint8_t)random();
+
+                reader.submitFrame(pixels.data(), width, height, rowBytes);
+                ImageModData pooled, reference;
+                reader.analyze(pooled);
+                CPUImageReader::analyzeReference(pixels.data(), width, height, rowBytes, reference);
+
+                const float difference = largestDifference(pooled, reference);
+                if (difference > 1.0e-5f)
+                    std::printf("  %d x %d differs by %g\n", width, height, difference);
+                worst = std::max(worst, difference);
+            }
+
+        std::printf("%d threads: ", reader.getNumThreads());
+        test::check(worst <= 1.0e-5f, "pool matches analyzeReference (largest difference)", worst);
+    }
+
+    // An unchanged frame is republished as it was
+    DirectReader reader(3);
+    std::vector<uint8_t> pixels(64 * 64 * 4);
+    for (auto& p : pixels)
+        p = (uint8_t)random();
+    reader.submitFrame(pixels.data(), 64, 64, 64 * 4);
+    ImageModData first, again;
+    reader.analyze(first);
+    reader.analyze(again);
+    test::check(largestDifference(first, again) == 0.0f, "unchanged frame republishes the same features (difference)",
+                largestDifference(first, again));
+
+    return test::failures;
+}
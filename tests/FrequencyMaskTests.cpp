@@ -0,0 +1,57 @@
+// tests/FrequencyMaskTests.cpp
+#include "../engine/SpectralProcessor.h"
+#include "TestUtils.h"
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numSamples = 188 * blockSize; // about two seconds per mask
+    constexpr int settle = numSamples - 24000;  // skipped: the glide towards the new mask
+
+    // Runs two seconds of a full-scale 1 kHz tone under a flat mask of the given gain
+    // and returns the level of the tone at the output once the mask has settled
+    double maskedLevel(SpectralProcessor& processor, float gain)
+    {
+        processor.setSpectralMask(std::vector<float>(64, gain));
+
+        std::vector<float> x((size_t)numSamples), y((size_t)numSamples);
+        for (int i = 0; i < numSamples; ++i)
+            x[(size_t)i] = (float)std::sin(2.0 * M_PI * 1000.0 * i / sampleRate);
+        for (int i = 0; i < numSamples; i += blockSize)
+            processor.process(x.data() + i, y.data() + i, blockSize);
+
+        return test::toneAmplitude(y.data() + settle, numSamples - settle, 1000.0, sampleRate);
+    }
+}
+
+int main()
+{
+    SpectralProcessor processor;
+    processor.prepareToPlay(sampleRate, blockSize);
+    processor.setMode(SpectralProcessor::Mode::FrequencyMask);
+    processor.setMaskSlew(100.0f);
+
+    const double open = maskedLevel(processor, 1.0f);
+    test::check(std::abs(open - 1.0) < 0.01, "open mask passes the tone (amplitude)", open);
+
+    const double closed = maskedLevel(processor, 0.0f);
+    test::check(closed < 1.0e-6, "closed mask removes the tone (amplitude)", closed);
+
+    // Gliding up from closed: each hop moves the gain only a fraction of the way,
+    // which stays under the -80 dB floor, yet the bins must still open
+    for (float gain : { 1.0e-2f, 2.0e-4f })
+    {
+        maskedLevel(processor, 0.0f);
+        const double level = maskedLevel(processor, gain);
+        test::check(std::abs(level / gain - 1.0) < 0.05, "quiet mask opens from closed (level / gain)", level / gain);
+    }
+
+    // Under the floor, bins close completely once the glide gets there
+    maskedLevel(processor, 1.0f);
+    const double floored = maskedLevel(processor, 5.0e-5f);
+    test::check(floored < 1.0e-6, "mask under -80 dB closes (amplitude)", floored);
+
+    return test::failures;
+}
@@ -0,0 +1,76 @@
+// tests/ImageScannerMipTests.cpp
+#include "../plugin/ImageScanner.h"
+#include "TestUtils.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    // Grey image whose value at (x, y) is shade(x, y) in 0..255
+    template <typename Shade>
+    juce::Image makeImage(int width, int height, Shade shade)
+    {
+        juce::Image image(juce::Image::ARGB, width, height, true);
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+            {
+                const auto v = (juce::uint8)shade(x, y);
+                image.setPixelAt(x, y, juce::Colour(v, v, v));
+            }
+        return image;
+    }
+
+    // Largest distance of any point from 0.5
+    double deviationFromHalf(const std::vector<float>& line)
+    {
+        double deviation = 0.0;
+        for (float v : line)
+            deviation = std::max(deviation, std::abs((double)v - 0.5));
+        return deviation;
+    }
+}
+
+int main()
+{
+    // 1-pixel stripes far narrower than the output spacing read as their average
+    // instead of aliasing to 0 or 1
+    ImageScanner stripes;
+    stripes.loadImage(makeImage(6000, 300, [](int x, int) { return (x & 1) ? 255 : 0; }));
+    for (int n : { 16, 1025, 3000 })
+    {
+        const double deviation = deviationFromHalf(stripes.getScanLine(0.5f, n));
+        std::printf("%d points: ", n);
+        test::check(deviation < 0.01, "vertical stripes read 0.5 (max deviation)", deviation);
+    }
+
+    // One point per pixel reads level 0 itself, so the stripes are still there
+    const auto full = stripes.getScanLine(0.5f, 6000);
+    const auto range = std::minmax_element(full.begin(), full.end());
+    test::check(*range.first < 0.01f && *range.second > 0.99f, "full resolution keeps the stripes (max - min)",
+                *range.second - *range.first);
+
+    ImageScanner rows;
+    rows.loadImage(makeImage(64, 6000, [](int, int y) { return (y & 1) ? 255 : 0; }));
+    const double rowDeviation = deviationFromHalf(rows.getVerticalScanLine(0.5f, 16));
+    test::check(rowDeviation < 0.01, "horizontal stripes read 0.5 down a column (max deviation)", rowDeviation);
+
+    // Filtering must not shift or bend a smooth ramp. Coarse levels blur the ends
+    // of the line by half a texel, so the bound is looser when points are few.
+    const int width = 6000;
+    ImageScanner ramp;
+    ramp.loadImage(makeImage(width, 64, [width](int x, int) { return x * 255 / (width - 1); }));
+    for (int n : { 16, 100, 1025 })
+    {
+        const auto line = ramp.getScanLine(0.3f, n);
+        double error = 0.0;
+        for (int i = 0; i < n; ++i)
+            error = std::max(error, std::abs((double)line[(size_t)i] - (double)i / (n - 1)));
+        std::printf("%d points: ", n);
+        test::check(error < (n < 100 ? 0.04 : 0.01), "ramp follows the gradient (max error)", error);
+    }
+
+    const double down = deviationFromHalf(ramp.getVerticalScanLine(0.5f, 16));
+    test::check(down < 0.01, "ramp is constant down its middle column (max deviation from 0.5)", down);
+
+    return test::failures;
+}
@@ -0,0 +1,93 @@
+// tests/ImageScannerRegionTests.cpp
+#include "../plugin/ImageScanner.h"
+#include "TestUtils.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Luminance mean and variance over an area in 0..1 coordinates, pixel by
+    // pixel, with the pixels the edges cut weighted by the part inside
+    ImageScanner::RegionStats bruteForce(const ImageScanner& scanner, juce::Rectangle<float> area)
+    {
+        const int width = scanner.getWidth(), height = scanner.getHeight();
+        const double x0 = area.getX() * width, x1 = area.getRight() * width;
+        const double y0 = area.getY() * height, y1 = area.getBottom() * height;
+        const auto overlap = [](double a0, double a1, int pixel)
+        {
+            return std::max(0.0, std::min(a1, pixel + 1.0) - std::max(a0, (double)pixel));
+        };
+
+        double weight = 0.0, sum = 0.0, squares = 0.0;
+        for (int y = (int)y0; y < std::min(height, (int)std::ceil(y1)); ++y)
+        {
+            const float* row = scanner.getLuminancePlane() + (size_t)y * (size_t)scanner.getPlaneStride();
+            for (int x = (int)x0; x < std::min(width, (int)std::ceil(x1)); ++x)
+            {
+                const double w = overlap(x0, x1, x) * overlap(y0, y1, y);
+                weight += w;
+                sum += w * row[x];
+                squares += w * row[x] * row[x];
+            }
+        }
+
+        ImageScanner::RegionStats stats;
+        stats.mean = (float)(sum / weight);
+        stats.variance = (float)(squares / weight - (sum / weight) * (sum / weight));
+        return stats;
+    }
+}
+
+int main()
+{
+    // A smooth gradient with noise on top: cells are not flat inside
+    const int width = 8192, height = 600;
+    juce::Image image(juce::Image::ARGB, width, height, true);
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> noise(-40, 40);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+        {
+            const auto v = (juce::uint8)juce::jlimit(0, 255, x * 200 / width + y * 40 / height + noise(random));
+            image.setPixelAt(x, y, juce::Colour(v, v, v));
+        }
+
+    ImageScanner scanner;
+    scanner.loadImage(image);
+    const int cell = scanner.getStatsCellSize();
+    std::printf("cell size %d\n", cell);
+
+    // Whole cells need no estimate at all
+    const juce::Rectangle<float> aligned(10.0f * cell / width, 3.0f * cell / height, 7.0f * cell / width, 5.0f * cell / height);
+    const double alignedError = std::abs(scanner.getRegionStats(aligned).mean - bruteForce(scanner, aligned).mean);
+    test::check(alignedError < 1.0e-5, "area on cell boundaries is exact (mean error)", alignedError);
+
+    // Arbitrary areas, from a few pixels to most of the image, stay inside the bound
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    double worstMean = 0.0, worstShare = 0.0, worstVariance = 0.0;
+    for (int i = 0; i < 500; ++i)
+    {
+        const float w = std::pow(unit(random), 3.0f) * 0.5f + 2.0f / width;
+        const float h = std::pow(unit(random), 2.0f) * 0.5f + 2.0f / height;
+        const juce::Rectangle<float> area(unit(random) * (1.0f - w), unit(random) * (1.0f - h), w, h);
+
+        const auto fast = scanner.getRegionStats(area);
+        const auto exact = bruteForce(scanner, area);
+        const double error = std::abs(fast.mean - exact.mean);
+        const double bound = (2.0 / (w * width) + 2.0 / (h * height)) * cell;
+        worstShare = std::max(worstShare, error / bound);
+
+        // Areas under a few cells across are mostly estimate; the rest should be close
+        if (w * width >= 4.0f * cell && h * height >= 4.0f * cell)
+        {
+            worstMean = std::max(worstMean, error);
+            worstVariance = std::max(worstVariance, (double)std::abs(fast.variance - exact.variance));
+        }
+    }
+    test::check(worstShare <= 1.0, "mean error within the documented bound (worst error / bound)", worstShare);
+    test::check(worstMean < 0.005, "mean error, areas 4+ cells across (worst)", worstMean);
+    test::check(worstVariance < 0.002, "variance error, areas 4+ cells across (worst)", worstVariance);
+
+    return test::failures;
+}
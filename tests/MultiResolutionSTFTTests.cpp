@@ -0,0 +1,63 @@
+// tests/MultiResolutionSTFTTests.cpp
+#include "../engine/MultiResolutionSTFT.h"
+#include "TestUtils.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numSamples = 48000;
+    constexpr int settle = 8000;            // longest band frame plus margin
+    constexpr int maskBins = 8193;
+
+    void run(MultiResolutionSTFT& stft, const std::vector<float>& x, std::vector<float>& y, const std::vector<float>& mask)
+    {
+        for (int i = 0; i < numSamples; i += 100)
+            stft.process(x.data() + i, y.data() + i, std::min(100, numSamples - i), mask.data(), maskBins);
+    }
+}
+
+int main()
+{
+    MultiResolutionSTFT stft;
+    stft.prepare(sampleRate);
+    const int latency = stft.getLatencySamples();
+    test::check(latency == 2 * MultiResolutionSTFT::synthesisHalfLength, "latency is 2 * M samples", latency);
+
+    std::vector<float> x((size_t)numSamples), y((size_t)numSamples);
+    std::vector<float> mask((size_t)maskBins, 1.0f);
+
+    // A unity mask: the three bands and their crossovers sum back to the input,
+    // delayed by exactly the reported latency
+    std::mt19937 random(1);
+    std::normal_distribution<float> noise;
+    for (auto& v : x)
+        v = noise(random);
+    run(stft, x, y, mask);
+
+    const int span = numSamples - settle;
+    const double aligned = test::snrDb(y.data() + settle, x.data() + settle - latency, span);
+    const double early = test::snrDb(y.data() + settle, x.data() + settle - latency + 1, span);
+    const double late = test::snrDb(y.data() + settle, x.data() + settle - latency - 1, span);
+    test::check(aligned > 40.0, "unity mask reconstructs white noise (SNR dB)", aligned);
+    test::check(aligned > early + 20.0 && aligned > late + 20.0, "reconstruction peaks at the reported latency (SNR dB one sample off)", std::max(early, late));
+
+    // A 1 kHz low-pass mask keeps a 100 Hz tone (low band) and removes 8 kHz (high band)
+    std::vector<float> reference((size_t)numSamples);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        x[(size_t)i] = (float)(std::sin(2.0 * M_PI * 100.0 * i / sampleRate) + std::sin(2.0 * M_PI * 8000.0 * i / sampleRate));
+        reference[(size_t)i] = (float)std::sin(2.0 * M_PI * 100.0 * (i - latency) / sampleRate);
+    }
+    for (int k = 0; k < maskBins; ++k)
+        mask[(size_t)k] = k * (sampleRate / 2.0) / (maskBins - 1) < 1000.0 ? 1.0f : 0.0f;
+
+    stft.reset();
+    run(stft, x, y, mask);
+    const double lowPass = test::snrDb(y.data() + settle, reference.data() + settle, span);
+    test::check(lowPass > 35.0, "low-pass mask keeps 100 Hz and removes 8 kHz (SNR dB)", lowPass);
+
+    return test::failures;
+}
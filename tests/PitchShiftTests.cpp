@@ -0,0 +1,74 @@
+// tests/PitchShiftTests.cpp
+#include "../engine/SpectralProcessor.h"
+#include "TestUtils.h"
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numSamples = 188 * blockSize;
+    constexpr int settle = 48000;           // skipped: start-up and phase-tracking lock-in
+
+    // Subtracts the least-squares sinusoid at frequencyHz from x
+    void removeTone(std::vector<double>& x, double frequencyHz)
+    {
+        const double w = 2.0 * M_PI * frequencyHz / sampleRate;
+        double c = 0.0, s = 0.0;
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            c += x[i] * std::cos(w * (double)i);
+            s += x[i] * std::sin(w * (double)i);
+        }
+        c *= 2.0 / (double)x.size();
+        s *= 2.0 / (double)x.size();
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] -= c * std::cos(w * (double)i) + s * std::sin(w * (double)i);
+    }
+}
+
+int main()
+{
+    SpectralProcessor processor;
+    processor.prepareToPlay(sampleRate, blockSize);
+    processor.setMode(SpectralProcessor::Mode::PitchShift);
+
+    std::vector<float> x((size_t)numSamples), y((size_t)numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        x[(size_t)i] = (float)(0.5 * std::sin(2.0 * M_PI * 440.0 * i / sampleRate)
+                             + 0.3 * std::sin(2.0 * M_PI * 1000.0 * i / sampleRate));
+
+    for (float semitones : { 7.0f, -5.0f, 12.0f })
+    {
+        std::printf("shift %+g semitones\n", semitones);
+        processor.setPitchShift(semitones);
+        for (int i = 0; i < numSamples; i += blockSize)
+            processor.process(x.data() + i, y.data() + i, blockSize);
+
+        // Both partials move by the ratio with their levels intact, nothing stays
+        // at the original pitch, and little energy lands anywhere else
+        const double ratio = std::pow(2.0, semitones / 12.0);
+        const float* tail = y.data() + settle;
+        const int n = numSamples - settle;
+        const double low = test::toneAmplitude(tail, n, 440.0 * ratio, sampleRate);
+        const double high = test::toneAmplitude(tail, n, 1000.0 * ratio, sampleRate);
+        const double original = test::toneAmplitude(tail, n, 440.0, sampleRate);
+        test::check(std::abs(low - 0.5) < 0.06, "440 Hz partial at the shifted frequency (amplitude)", low);
+        test::check(std::abs(high - 0.3) < 0.04, "1 kHz partial at the shifted frequency (amplitude)", high);
+        test::check(original < 0.01, "nothing left at 440 Hz (amplitude)", original);
+
+        std::vector<double> residual(tail, tail + n);
+        double total = 0.0;
+        for (double v : residual)
+            total += v * v;
+        removeTone(residual, 440.0 * ratio);
+        removeTone(residual, 1000.0 * ratio);
+        double rest = 0.0;
+        for (double v : residual)
+            rest += v * v;
+        const double residualDb = 10.0 * std::log10(rest / total);
+        test::check(residualDb < -30.0, "non-harmonic residual (dB below the output)", residualDb);
+    }
+
+    return test::failures;
+}
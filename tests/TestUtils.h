@@ -0,0 +1,50 @@
+// tests/TestUtils.h
+#pragma once
+#include <cmath>
+#include <cstdio>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Minimal support for the standalone test executables: every check is printed
+// with the value it measured, and main returns the number of failures.
+namespace test
+{
+    inline int failures = 0;
+
+    inline void check(bool condition, const char* description, double value)
+    {
+        std::printf("%s  %s (%g)\n", condition ? "pass" : "FAIL", description, value);
+        if (!condition)
+            ++failures;
+    }
+
+    // Amplitude of the sinusoid at frequencyHz in x (Goertzel over the whole span)
+    inline double toneAmplitude(const float* x, int numSamples, double frequencyHz, double sampleRate)
+    {
+        const double w = 2.0 * M_PI * frequencyHz / sampleRate;
+        const double c = 2.0 * std::cos(w);
+        double s1 = 0.0, s2 = 0.0;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double s = x[i] + c * s1 - s2;
+            s2 = s1;
+            s1 = s;
+        }
+        return 2.0 * std::sqrt(s1 * s1 + s2 * s2 - c * s1 * s2) / numSamples;
+    }
+
+    // Ratio in dB of the reference's energy to the energy of y - reference
+    inline double snrDb(const float* y, const float* reference, int numSamples)
+    {
+        double signal = 0.0, error = 0.0;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double d = (double)y[i] - (double)reference[i];
+            signal += (double)reference[i] * reference[i];
+            error += d * d;
+        }
+        return error > 0.0 ? 10.0 * std::log10(signal / error) : 300.0;
+    }
+}
@@ -1,10 +1,35 @@
 // source/ui/ImageCanvas.cpp
 #include "ImageCanvas.h"
 #include "../plugin/ImageScanner.h"
+#include "../plugin/ImageLoader.h"
 
 ImageCanvas::ImageCanvas()
 {
     setWantsKeyboardFocus(true);
+    
+    loader = std::make_unique<ImageLoader>();
+    loader->onPreview = [this](const juce::Image& image, int, int) {
+        preview = image;
+        tiles = nullptr;
+        fullImage = {};
+        repaint();
+    };
+    loader->onTiles = [this](std::shared_ptr<const TiledImage> fullResolution) {
+        tiles = std::move(fullResolution);
+        repaint();
+    };
+    loader->onScanner = [this](std::unique_ptr<ImageScanner> scanner, const juce::File& file) {
+        if (imageScanner) {
+            imageScanner->swap(*scanner);
+            if (tiles == nullptr)
+                fullImage = imageScanner->getImage();
+        }
+        repaint();
+        
+        if (onImageLoaded) {
+            onImageLoaded(file);
+        }
+    };
 }
 
 ImageCanvas::~ImageCanvas() = default;
@@ -23,7 +48,7 @@ void ImageCanvas::paint(juce::Graphics& g)
     g.setColour(borderColor);
     g.drawRect(getLocalBounds(), 1);
     
-    if (!imageScanner || !imageScanner->hasImage()) {
+    if (!hasDisplayImage()) {
         // Draw placeholder text
         g.setColour(juce::Colours::grey);
         g.drawText("Drop image here", getLocalBounds(), juce::Justification::centred);
@@ -34,8 +59,7 @@ void ImageCanvas::paint(juce::Graphics& g)
     auto imageBounds = getImageDisplayBounds();
     
     // Draw the image
-    const auto& image = imageScanner->getImage();
-    g.drawImage(image, imageBounds, juce::RectanglePlacement::stretchToFit);
+    drawDisplayImage(g, imageBounds);
     
     // Draw crosshairs for scan position
     if (showCrosshairs) {
@@ -62,7 +86,7 @@ void ImageCanvas::resized()
 
 void ImageCanvas::mouseDown(const juce::MouseEvent& e)
 {
-    if (!imageScanner || !imageScanner->hasImage()) return;
+    if (!hasDisplayImage()) return;
     
     auto imagePos = screenToImageCoords(e.getPosition());
     
@@ -126,20 +150,60 @@ void ImageCanvas::setImageScanner(ImageScanner* scanner)
 
 void ImageCanvas::loadImage(const juce::File& imageFile)
 {
-    if (imageScanner && imageScanner->loadImage(imageFile)) {
-        repaint();
-        
-        if (onImageLoaded) {
-            onImageLoaded(imageFile);
-        }
+    if (imageScanner) {
+        loader->load(imageFile);
     }
 }
 
 void ImageCanvas::clearImage()
 {
+    loader->cancel();
+    preview = {};
+    tiles = nullptr;
+    fullImage = {};
+    
     if (imageScanner) {
         imageScanner->clearImage();
-        repaint();
+    }
+    repaint();
+}
+
+bool ImageCanvas::hasDisplayImage() const
+{
+    return preview.isValid() || (imageScanner && imageScanner->hasImage());
+}
+
+void ImageCanvas::drawDisplayImage(juce::Graphics& g, juce::Rectangle<float> imageBounds) const
+{
+    // The cheapest source that still has enough pixels for the displayed size
+    const bool previewIsEnough = preview.isValid()
+                              && imageBounds.getWidth() <= (float)preview.getWidth()
+                              && imageBounds.getHeight() <= (float)preview.getHeight();
+    
+    if (!previewIsEnough && tiles != nullptr) {
+        // Only tiles that meet the clip region are drawn
+        const float scaleX = imageBounds.getWidth() / (float)tiles->width;
+        const float scaleY = imageBounds.getHeight() / (float)tiles->height;
+        const auto clip = g.getClipBounds().toFloat();
+        
+        for (int ty = 0; ty < tiles->tilesY; ++ty) {
+            for (int tx = 0; tx < tiles->tilesX; ++tx) {
+                const auto source = tiles->getTileBounds(tx, ty).toFloat();
+                const juce::Rectangle<float> dest(imageBounds.getX() + source.getX() * scaleX,
+                                                  imageBounds.getY() + source.getY() * scaleY,
+                                                  source.getWidth() * scaleX,
+                                                  source.getHeight() * scaleY);
+                if (dest.intersects(clip)) {
+                    g.drawImage(tiles->getTile(tx, ty), dest, juce::RectanglePlacement::stretchToFit);
+                }
+            }
+        }
+    } else if (!previewIsEnough && fullImage.isValid()) {
+        g.drawImage(fullImage, imageBounds, juce::RectanglePlacement::stretchToFit);
+    } else if (preview.isValid()) {
+        g.drawImage(preview, imageBounds, juce::RectanglePlacement::stretchToFit);
+    } else {
+        g.drawImage(imageScanner->getImage(), imageBounds, juce::RectanglePlacement::stretchToFit);
     }
 }
 
@@ -166,7 +230,7 @@ juce::Point<float> ImageCanvas::screenToImageCoords(juce::Point<int> screenPos)
 
 juce::Rectangle<float> ImageCanvas::getImageDisplayBounds() const
 {
-    if (!imageScanner || !imageScanner->hasImage()) {
+    if (!hasDisplayImage()) {
         return {};
     }
     
@@ -3,6 +3,8 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 
 class ImageScanner; // Forward declaration only
+class ImageLoader;
+struct TiledImage;
 
 class ImageCanvas : public juce::Component,
                    public juce::FileDragAndDropTarget
@@ -21,6 +23,9 @@ public:
     void filesDropped(const juce::StringArray& files, int x, int y) override;
     
     void setImageScanner(ImageScanner* scanner);
+    
+    // Decodes on a background thread: a preview shows first, the scanner is
+    // updated (and onImageLoaded called) once the analysis is ready
     void loadImage(const juce::File& imageFile);
     void clearImage();
     void setScanPosition(float x, float y);
@@ -31,11 +36,19 @@ public:
 
 private:
     ImageScanner* imageScanner = nullptr;
+    std::unique_ptr<ImageLoader> loader;
+    
+    // What is drawn while and after loading, coarse to fine
+    juce::Image preview;                        // at most ImageLoader::previewSize
+    std::shared_ptr<const TiledImage> tiles;    // full resolution of very large images
+    juce::Image fullImage;                      // full resolution otherwise (the scanner's)
     float scanX = 0.5f;
     float scanY = 0.5f;
     bool showCrosshairs = true;
     bool isPainting = false;
     
+    bool hasDisplayImage() const;
+    void drawDisplayImage(juce::Graphics& g, juce::Rectangle<float> imageBounds) const;
     juce::Point<float> screenToImageCoords(juce::Point<int> screenPos) const;
     juce::Rectangle<float> getImageDisplayBounds() const;
     
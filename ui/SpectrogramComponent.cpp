@@ -0,0 +1,90 @@
+// source/ui/SpectrogramComponent.cpp
+#include "SpectrogramComponent.h"
+#include <cmath>
+
+SpectrogramComponent::SpectrogramComponent(SpectrumTap& tapToShow)
+    : tap(tapToShow)
+{
+    // Black -> blue -> cyan -> yellow -> white, indexed by level 0..255
+    juce::ColourGradient gradient(juce::Colours::black, 0.0f, 0.0f, juce::Colours::white, 1.0f, 0.0f, false);
+    gradient.addColour(0.35, juce::Colour(0xff003a66));
+    gradient.addColour(0.65, juce::Colours::cyan);
+    gradient.addColour(0.85, juce::Colours::yellow);
+    for (size_t i = 0; i < palette.size(); ++i)
+        palette[i] = gradient.getColourAtPosition((double)i / (double)(palette.size() - 1)).getPixelARGB();
+
+    setOpaque(true);
+    tap.setEnabled(true);
+    startTimerHz(60);
+}
+
+SpectrogramComponent::~SpectrogramComponent()
+{
+    stopTimer();
+    tap.setEnabled(false);
+}
+
+void SpectrogramComponent::setDynamicRange(float decibels)
+{
+    dynamicRange = juce::jmax(6.0f, decibels);
+}
+
+void SpectrogramComponent::paint(juce::Graphics& g)
+{
+    if (!image.isValid())
+    {
+        g.fillAll(juce::Colours::black);
+        return;
+    }
+
+    // Oldest columns start at writeColumn: unroll the ring, no scaling
+    const int width = image.getWidth(), height = image.getHeight();
+    g.drawImage(image, 0, 0, width - writeColumn, height, writeColumn, 0, width - writeColumn, height);
+    if (writeColumn > 0)
+        g.drawImage(image, width - writeColumn, 0, writeColumn, height, 0, 0, writeColumn, height);
+}
+
+void SpectrogramComponent::resized()
+{
+    const int width = juce::jmax(1, getWidth()), height = juce::jmax(1, getHeight());
+    image = juce::Image(juce::Image::ARGB, width, height, false);
+    image.clear(image.getBounds(), juce::Colours::black);
+    writeColumn = 0;
+
+    rowBand.resize((size_t)height);
+    for (int y = 0; y < height; ++y)
+        rowBand[(size_t)y] = SpectrumTap::numBands - 1 - (int)(((float)y + 0.5f) * (float)SpectrumTap::numBands / (float)height);
+}
+
+void SpectrogramComponent::timerCallback()
+{
+    bool drawn = false;
+    while (tap.pop(incoming))
+    {
+        drawColumn(incoming);
+        drawn = true;
+    }
+
+    if (drawn)
+        repaint();
+}
+
+void SpectrogramComponent::drawColumn(const SpectrumTap::Column& column)
+{
+    if (!image.isValid())
+        return;
+
+    // Level per band once, then one palette lookup per pixel row
+    const float levelsPerDb = 255.0f / dynamicRange;
+    for (int b = 0; b < SpectrumTap::numBands; ++b)
+    {
+        const float db = 20.0f * std::log10(column.amplitude[(size_t)b] + 1.0e-9f);
+        bandLevel[(size_t)b] = (uint8_t)juce::jlimit(0.0f, 255.0f, (db + dynamicRange) * levelsPerDb);
+    }
+
+    juce::Image::BitmapData pixels(image, writeColumn, 0, 1, image.getHeight(), juce::Image::BitmapData::writeOnly);
+    for (int y = 0; y < image.getHeight(); ++y)
+        *reinterpret_cast<juce::PixelARGB*>(pixels.getPixelPointer(0, y)) = palette[bandLevel[(size_t)rowBand[(size_t)y]]];
+
+    writeColumn = writeColumn + 1 < image.getWidth() ? writeColumn + 1 : 0;
+}
@@ -0,0 +1,38 @@
+// source/ui/SpectrogramComponent.h
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../engine/SpectrumTap.h"
+#include <array>
+#include <vector>
+
+// Scrolling spectrogram of a SpectrumTap (newest column on the right, low
+// frequencies at the bottom). The image is a ring of columns: each column that
+// arrives is drawn once into the next slot, and paint() blits the ring in two
+// unscaled pieces, so a frame costs the new columns plus two image copies.
+class SpectrogramComponent : public juce::Component,
+                             private juce::Timer
+{
+public:
+    explicit SpectrogramComponent(SpectrumTap& tapToShow);
+    ~SpectrogramComponent() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    void setDynamicRange(float decibels);     // levels below -decibels dBFS are black
+
+private:
+    void timerCallback() override;
+    void drawColumn(const SpectrumTap::Column& column);
+
+    SpectrumTap& tap;
+    juce::Image image;                        // one pixel per column, same size as the component
+    int writeColumn = 0;                      // next (oldest) column in the ring
+    std::vector<int> rowBand;                 // band shown on each pixel row, top row first
+    std::array<juce::PixelARGB, 256> palette;
+    std::array<uint8_t, SpectrumTap::numBands> bandLevel {};
+    float dynamicRange = 90.0f;
+    SpectrumTap::Column incoming;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrogramComponent)
+};